@@ -0,0 +1,121 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <ledger.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+
+using namespace std;
+
+/*
+ * Shared harness for the benchmarks: a pool of writer threads issuing
+ * random deposits, withdrawals and transfers against `bench_bank` until
+ * `stop_writers` is called, and a generator for skewed ledger files. Each
+ * benchmark is a single translation unit.
+ */
+
+const int MAX_BENCH_WRITERS = 64;
+
+static QuietBank *bench_bank;				 // bank under test, without console output
+static int num_accounts;					 // number of accounts
+static volatile int running;				 // writers run while set
+static long writer_ops[MAX_BENCH_WRITERS];	 // operations completed per writer
+static pthread_t writers[MAX_BENCH_WRITERS]; // writer threads
+static int writer_ids[MAX_BENCH_WRITERS];	 // writer IDs
+static fstream null_log;					 // log sink
+
+static inline double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline void *bench_writer(void *arg)
+{
+	int id = *(int *)arg;
+	unsigned int seed = SEED_RANDOM + id;
+	long ops = 0;
+	while (running)
+	{
+		int acc = rand_r(&seed) % num_accounts;
+		int other = rand_r(&seed) % num_accounts;
+		int amount = rand_r(&seed) % 100;
+		switch (rand_r(&seed) % 3)
+		{
+		case D:
+			bench_bank->deposit(id, ops, acc, amount, &null_log);
+			break;
+		case W:
+			bench_bank->withdraw(id, ops, acc, amount, &null_log);
+			break;
+		case T:
+			bench_bank->transfer(id, ops, acc, other, amount, &null_log, &null_log);
+			break;
+		}
+		ops++;
+	}
+	writer_ops[id] = ops;
+	return NULL;
+}
+
+static inline void start_writers(int num_writers)
+{
+	if (!null_log.is_open())
+	{
+		null_log.open("/dev/null", ios::out);
+	}
+	running = 1;
+	for (int i = 0; i < num_writers; i++)
+	{
+		writer_ids[i] = i;
+		pthread_create(&writers[i], NULL, bench_writer, &writer_ids[i]);
+	}
+}
+
+// stops the writers and returns the total number of operations they did
+static inline long stop_writers(int num_writers)
+{
+	running = 0;
+	long ops = 0;
+	for (int i = 0; i < num_writers; i++)
+	{
+		pthread_join(writers[i], NULL);
+		ops += writer_ops[i];
+	}
+	return ops;
+}
+
+// writes a ledger whose accounts follow a Zipf distribution with exponent `skew`
+static inline void make_ledger(const char *path, long entries, double skew)
+{
+	const int accounts = 10; // InitBank always opens 10 accounts
+	double cdf[accounts], sum = 0;
+	for (int i = 0; i < accounts; i++)
+	{
+		sum += 1 / pow(i + 1, skew);
+		cdf[i] = sum;
+	}
+
+	unsigned int seed = SEED_RANDOM;
+	ofstream out(path);
+	for (long i = 0; i < entries; i++)
+	{
+		int acc[2];
+		for (int k = 0; k < 2; k++)
+		{
+			double u = (double)rand_r(&seed) / RAND_MAX * sum;
+			acc[k] = 0;
+			while (acc[k] < accounts - 1 && cdf[acc[k]] < u)
+			{
+				acc[k]++;
+			}
+		}
+		int r = rand_r(&seed) % 10;
+		int mode = r < 6 ? D : r < 8 ? W : T; // mostly deposits
+		out << acc[0] << " " << acc[1] << " " << rand_r(&seed) % 100 << " " << mode << "\n";
+	}
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "bench.h"
+
+using namespace std;
+
+/*
+ * Measures audit latency on a large bank while writers keep updating it,
+ * and how much the audits cost the writers.
+ *
+ * Usage: bench_audit [accounts] [writers] [seconds]
+ */
+
+// run the writers for `seconds`, auditing continuously if `audit` is set
+double run(int num_writers, double seconds, bool audit)
+{
+	start_writers(num_writers);
+	int audits = 0, failed = 0;
+	double worst = 0, spent = 0, start = now();
+	while (now() - start < seconds)
+	{
+		if (!audit)
+		{
+			usleep(10000);
+			continue;
+		}
+		struct AuditReport report;
+		double t = now();
+		audit_bank(bench_bank, &report);
+		t = now() - t;
+		failed += !report.conserved;
+		spent += t;
+		worst = t > worst ? t : worst;
+		audits++;
+	}
+	long ops = stop_writers(num_writers);
+	double elapsed = now() - start;
+	if (audit)
+	{
+		cerr << "  audits: " << audits << " avg " << spent / audits * 1e3 << " ms, worst " << worst * 1e3
+			 << " ms, mismatches " << failed << endl;
+	}
+	return ops / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+	num_accounts = argc > 1 ? atoi(argv[1]) : 1000000;
+	int num_writers = argc > 2 ? atoi(argv[2]) : 2;
+	double seconds = argc > 3 ? atof(argv[3]) : 2;
+	num_writers = min(num_writers, MAX_BENCH_WRITERS);
+
+	bench_bank = new QuietBank(num_accounts);
+
+	cerr << "accounts " << num_accounts << ", writers " << num_writers << endl;
+	double base = run(num_writers, seconds, false);
+	cerr << "  writers alone: " << (long)base << " ops/s" << endl;
+	double with_audit = run(num_writers, seconds, true);
+	cerr << "  writers while auditing: " << (long)with_audit << " ops/s" << endl;
+
+	struct AuditReport report;
+	double t = now();
+	audit_bank(bench_bank, &report);
+	t = now() - t;
+	cerr << "  quiescent audit: " << t * 1e3 << " ms" << endl;
+	print_audit(&report);
+
+	delete bench_bank;
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include "bench.h"
+
+using namespace std;
+
+/*
+ * Compares the text account logs with binary log records: bytes written
+ * and append throughput for the same sequence of operations.
+ *
+ * Usage: bench_log [records] [directory]
+ */
+
+// the sequence of operations to log, mixed like a ledger
+void make_records(vector<LogRecord> *records, long n)
+{
+	unsigned int seed = SEED_RANDOM;
+	for (long i = 0; i < n; i++)
+	{
+		LogRecord rec;
+		int op = rand_r(&seed) % 5;
+		int status = rand_r(&seed) % 4 == 0 ? LOG_FAILED : LOG_SUCCESS;
+		make_log_record(&rec, op, status, rand_r(&seed) % 1000, op == LOG_TRANSFER_OUT || op == LOG_TRANSFER_IN ? rand_r(&seed) % 10 : -1, i);
+		records->push_back(rec);
+	}
+}
+
+// append every record to `path` as text or binary, returning records/s
+double run(const char *name, string path, vector<LogRecord> *records, bool binary)
+{
+	fstream file(path, ios::out | ios::trunc | (binary ? ios::binary : ios::out));
+	double start = now();
+	for (size_t i = 0; i < records->size(); i++)
+	{
+		if (binary)
+		{
+			write_log_record(&file, &(*records)[i]);
+		}
+		else
+		{
+			file << render_log_record(&(*records)[i]) + "\n";
+		}
+	}
+	file.close();
+	double elapsed = now() - start;
+
+	ifstream written(path, ios::binary | ios::ate);
+	long bytes = written.tellg();
+	cerr << "  " << name << ": " << bytes << " bytes (" << (double)bytes / records->size() << " per record), "
+		 << (long)(records->size() / elapsed) << " records/s, " << bytes / elapsed / 1e6 << " MB/s" << endl;
+	remove(path.c_str());
+	return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+	long n = argc > 1 ? atol(argv[1]) : 2000000;
+	string dir = argc > 2 ? argv[2] : ".";
+
+	vector<LogRecord> records;
+	make_records(&records, n);
+
+	cerr << "records " << n << endl;
+	double text = run("text", dir + "/bench_log.txt", &records, false);
+	double binary = run("binary", dir + "/bench_log.bin", &records, true);
+	cerr << "  binary speedup: " << text / binary << "x" << endl;
+	return 0;
+}
@@ -0,0 +1,52 @@
+#include "bench.h"
+
+using namespace std;
+
+/*
+ * Runs the same ledger through every bank configuration and compares
+ * throughput. SerialBank always runs with a single worker.
+ *
+ * Usage: bench_presets [entries] [workers] [skew] [runs]
+ */
+
+// runs the ledger on `BankT` and returns the best entries per second
+template <class BankT>
+void run(const char *name, char *path, long entries, int workers, int runs)
+{
+	double best = 0;
+	for (int r = 0; r < runs; r++)
+	{
+		double start = now();
+		RunLedger<BankT>(workers, path);
+		double rate = entries / (now() - start);
+		best = rate > best ? rate : best;
+	}
+	cerr << "  " << name << ": " << (long)best << " entries/s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	long entries = argc > 1 ? atol(argv[1]) : 200000;
+	int workers = argc > 2 ? atoi(argv[2]) : 4;
+	double skew = argc > 3 ? atof(argv[3]) : 0;
+	int runs = argc > 4 ? atoi(argv[4]) : 3;
+
+	char path[] = "bench_ledger.txt";
+	make_ledger(path, entries, skew);
+	ofstream sink("/dev/null");
+	streambuf *old = cout.rdbuf(sink.rdbuf()); // console output still costs, it just goes nowhere
+
+	cerr << "entries " << entries << ", workers " << workers << ", zipf skew " << skew << endl;
+	run<Bank>("Bank", path, entries, workers, runs);
+	run<QuietBank>("QuietBank", path, entries, workers, runs);
+	run<LeanBank>("LeanBank", path, entries, workers, runs);
+	run<SerialBank>("SerialBank", path, entries, 1, runs);
+	cout.rdbuf(old);
+
+	remove(path);
+	for (int i = 0; i < 10; i++)
+	{
+		remove(("log_account_" + to_string(i) + ".bin").c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include "bench.h"
+
+using namespace std;
+
+/*
+ * Measures full-bank report latency and writer throughput while reports
+ * are taken back to back, comparing the old per-account read locks with
+ * lock-free snapshot reads.
+ *
+ * Usage: bench_snapshot [accounts] [writers] [seconds]
+ */
+
+// a full-bank report walking the accounts under per-account read locks
+long report_locked()
+{
+	long total = 0;
+	for (int i = 0; i < num_accounts; i++)
+	{
+		bench_bank->accounts[i].lock_read();
+		total += bench_bank->accounts[i].balance;
+		bench_bank->accounts[i].unlock_read();
+	}
+	return total;
+}
+
+// a full-bank report read from a single snapshot
+long report_snapshot()
+{
+	long total = 0;
+	Snapshot snap;
+	bench_bank->open_snapshot(&snap);
+	for (int i = 0; i < num_accounts; i++)
+	{
+		total += bench_bank->read_balance(i, &snap);
+	}
+	bench_bank->close_snapshot(&snap);
+	return total;
+}
+
+// run the writers for `seconds` while taking reports with `report` (or none)
+void run(const char *name, int num_writers, double seconds, long (*report)())
+{
+	start_writers(num_writers);
+	int reports = 0;
+	double worst = 0, spent = 0, start = now();
+	while (now() - start < seconds)
+	{
+		if (report == NULL)
+		{
+			usleep(10000);
+			continue;
+		}
+		double t = now();
+		report();
+		t = now() - t;
+		spent += t;
+		worst = t > worst ? t : worst;
+		reports++;
+	}
+	long ops = stop_writers(num_writers);
+	double elapsed = now() - start;
+	cerr << "  " << name << ": writers " << (long)(ops / elapsed) << " ops/s";
+	if (reports > 0)
+	{
+		cerr << ", reports " << reports << " avg " << spent / reports * 1e3 << " ms, worst " << worst * 1e3 << " ms";
+	}
+	cerr << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	num_accounts = argc > 1 ? atoi(argv[1]) : 100000;
+	int num_writers = argc > 2 ? atoi(argv[2]) : 2;
+	double seconds = argc > 3 ? atof(argv[3]) : 2;
+	num_writers = min(num_writers, MAX_BENCH_WRITERS);
+
+	bench_bank = new QuietBank(num_accounts);
+
+	cerr << "accounts " << num_accounts << ", writers " << num_writers << endl;
+	run("no reports", num_writers, seconds, NULL);
+	run("read locks", num_writers, seconds, report_locked);
+	run("snapshots", num_writers, seconds, report_snapshot);
+
+	delete bench_bank;
+	return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef _AUDIT_H
+#define _AUDIT_H
+
+#include <bank.h>
+
+using namespace std;
+
+// Result of a bank-wide audit
+struct AuditReport
+{
+	long total;				// Sum of all balances
+	long min_balance;		// Smallest balance
+	long max_balance;		// Largest balance
+	long negatives;			// Number of accounts below zero
+	long deposited;			// Sum of all deposits
+	long withdrawn;			// Sum of all withdrawals
+	unsigned long version;	// Commit timestamp the snapshot was taken at
+	bool conserved;			// deposited - withdrawn == total
+};
+
+// Kernels over a structure-of-arrays column of length n
+long audit_sum(const long *column, int n);
+void audit_min_max(const long *column, int n, long *min_out, long *max_out);
+long audit_count_negative(const long *column, int n);
+
+// Function to snapshot the bank and check the conservation of money
+int audit_bank(BankCore *bank, struct AuditReport *report);
+
+// Function to print an audit report
+void print_audit(struct AuditReport *report);
+
+#endif
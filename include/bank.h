@@ -13,14 +13,30 @@
 #include <list>
 #include <array>
 #include <pthread.h>
+#include <vector>
+#include <log_record.h>
 
 using namespace std;
 
+// Structure representing one published version of an account's balance
+struct BalanceVersion
+{
+  long balance;
+  long deposited;
+  long withdrawn;
+  unsigned long ts;            // commit timestamp (epoch) of this version
+  struct BalanceVersion *prev; // next older version, NULL when reclaimed
+};
+
 // Structure representing an account
 struct Account
 {
   unsigned int accountID;
   long balance;
+  long deposited;              // total ever deposited (for audits)
+  long withdrawn;              // total ever withdrawn (for audits)
+  struct BalanceVersion *head;  // newest version, NULL if never updated
+  struct BalanceVersion *spare; // reclaimed versions kept for reuse
   int read_count;
   pthread_mutex_t read_lock, write_lock;
 
@@ -98,36 +114,189 @@ struct AccountLog
   }
 };
 
-// Class representing a bank
-class Bank
+// Maximum number of snapshots open at the same time
+const int MAX_SNAPSHOTS = 16;
+
+// Commits that may be in progress before new ones wait for visibility to
+// catch up
+const int COMMIT_RING = 1024;
+
+// Reader slot states that are not epochs
+const unsigned long EPOCH_IDLE = ~0UL;        // slot is free
+const unsigned long EPOCH_PENDING = ~0UL - 1; // slot is claimed, epoch not yet announced
+
+// Structure-of-arrays copy of every account, filled by a snapshot
+struct BalanceColumns
 {
-private:
+  long *balance;   // balance of each account
+  long *deposited; // deposit total of each account
+  long *withdrawn; // withdrawal total of each account
+};
+
+// Structure representing a point-in-time view of the bank
+struct Snapshot
+{
+  int slot;         // reader slot announcing our epoch
+  unsigned long ts; // commit timestamp the view is taken at
+};
+
+// Locking policy: per-account reader/writer locks and a global bank lock
+struct MutexLocking
+{
+  static constexpr bool thread_safe = true;
+  template <class L> static void lock_read(L *l) { l->lock_read(); }
+  template <class L> static void unlock_read(L *l) { l->unlock_read(); }
+  template <class L> static void lock_write(L *l) { l->lock_write(); }
+  template <class L> static void unlock_write(L *l) { l->unlock_write(); }
+  static void lock(pthread_mutex_t *m) { pthread_mutex_lock(m); }
+  static void unlock(pthread_mutex_t *m) { pthread_mutex_unlock(m); }
+};
+
+// Locking policy: no locks, for a bank used by a single worker
+struct NoLocking
+{
+  static constexpr bool thread_safe = false;
+  template <class L> static void lock_read(L *) {}
+  template <class L> static void unlock_read(L *) {}
+  template <class L> static void lock_write(L *) {}
+  template <class L> static void unlock_write(L *) {}
+  static void lock(pthread_mutex_t *) {}
+  static void unlock(pthread_mutex_t *) {}
+};
+
+// Logging policy: binary log records in the per-account log files
+struct BinaryLog
+{
+  static constexpr bool enabled = true;
+  static void write(fstream *file, const struct LogRecord *rec) { write_log_record(file, rec); }
+};
+
+// Logging policy: no per-account logs
+struct NoLog
+{
+  static constexpr bool enabled = false;
+  static void write(fstream *, const struct LogRecord *) {}
+};
+
+// Stats policy: count successes and failures and print every operation
+struct ConsoleStats
+{
+  static constexpr bool count = true;
+  static constexpr bool print = true;
+};
+
+// Stats policy: count successes and failures silently
+struct CountingStats
+{
+  static constexpr bool count = true;
+  static constexpr bool print = false;
+};
+
+// Stats policy: no counters, no console output
+struct NoStats
+{
+  static constexpr bool count = false;
+  static constexpr bool print = false;
+};
+
+// Versioning policy: publish a balance version per commit, so snapshots and
+// audits read without blocking writers
+struct MultiVersion
+{
+  static constexpr bool enabled = true;
+};
+
+// Versioning policy: no versions, snapshots and audits read the live
+// balances under the account locks
+struct NoVersions
+{
+  static constexpr bool enabled = false;
+};
+
+// Class representing the accounts and balance versions shared by every bank
+// configuration
+class BankCore
+{
+protected:
   int num;
+  bool versioned;                            // whether writers publish balance versions
   int num_succ;
   int num_fail;
+  unsigned long next_ts;                     // last commit timestamp handed out
+  unsigned long visible_ts;                  // last commit timestamp readers may see
+  unsigned long commit_done[COMMIT_RING];    // timestamp of the last finished commit in each slot
+  unsigned long reader_epochs[MAX_SNAPSHOTS]; // epoch announced by each open snapshot
+  struct BalanceColumns columns;             // reused by every audit, allocated by the first
+  pthread_mutex_t columns_lock;              // one audit at a time owns the columns
+
+  // Versioning helpers (dest = -1 for one account), called under write locks
+  void publish(int accountID, int dest = -1);
+  void install(int accountID, unsigned long ts);
+  void advance_visible();
+  void reclaim(int accountID);
+  unsigned long oldest_epoch();
 
 public:
   // Constructor
-  Bank(int N);
+  BankCore(int N, bool versioned);
 
   // Destructor
-  ~Bank();
+  ~BankCore();
+
+  // Utility methods
+  void print_account();
+
+  // Snapshot reads
+  void open_snapshot(struct Snapshot *snap);
+  void close_snapshot(struct Snapshot *snap);
+  struct BalanceVersion *read_version(int accountID, struct Snapshot *snap);
+  long read_balance(int accountID, struct Snapshot *snap);
+
+  // Audit support
+  int size() { return num; }
+  struct BalanceColumns *lock_columns();
+  void unlock_columns();
+  unsigned long snapshot(struct BalanceColumns *cols);
+
+  pthread_mutex_t bank_lock;
+  struct Account *accounts;
+  struct AccountLog *accountLogs;
+};
+
+// Class representing a bank whose locking, logging, stats and versioning
+// are chosen at compile time; the configurations below are instantiated in
+// bank.cpp
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+class BasicBank : public BankCore
+{
+public:
+  typedef LockPolicy lock_policy;
+  typedef LogPolicy log_policy;
+  typedef StatsPolicy stats_policy;
+  typedef VersionPolicy version_policy;
+
+  // Constructor
+  BasicBank(int N) : BankCore(N, VersionPolicy::enabled) {}
 
   // Bank operations
   int deposit(int workerID, int ledgerID, int accountID, int amount, fstream *file);
+  int deposit_many(int workerID, int count, const int *ledgerIDs, int accountID, const int *amounts, fstream *file);
   int withdraw(int workerID, int ledgerID, int accountID, int amount, fstream *file);
   int transfer(int workerID, int ledgerID, int src_id, int dest_id, unsigned int amount, fstream *file, fstream *file2);
   int check_balance(int workerID, int ledgerID, int accountID, fstream *file);
   int printAccountLog(int workerID, int ledgerID, int accountID, fstream *file);
 
-  // Utility methods
-  void print_account();
-  void recordSucc(char *message);
-  void recordFail(char *message);
-
-  pthread_mutex_t bank_lock;
-  struct Account *accounts;
-  struct AccountLog *accountLogs;
+private:
+  // Stats helpers; `message` is a callable returning the text to print, so
+  // it is never built when the stats policy does not print
+  template <class Message> void recordSucc(Message message);
+  template <class Message> void recordFail(Message message);
 };
 
+// Bank configurations
+typedef BasicBank<MutexLocking, BinaryLog, ConsoleStats, MultiVersion> Bank;       // everything on (default)
+typedef BasicBank<MutexLocking, BinaryLog, CountingStats, MultiVersion> QuietBank; // no console output
+typedef BasicBank<MutexLocking, NoLog, CountingStats, NoVersions> LeanBank;        // counters only, locked reads
+typedef BasicBank<NoLocking, NoLog, NoStats, NoVersions> SerialBank;               // single worker, balances only
+
 #endif
@@ -2,6 +2,7 @@
 #define _LEDGER_H
 
 #include <bank.h>
+#include <audit.h>
 
 using namespace std;
 
@@ -15,6 +16,12 @@ using namespace std;
 // Seed for random number generation
 const int SEED_RANDOM = 377;
 
+// Admission control: how many queued entries a worker looks through for one
+// that does not touch a hot account, and how many workers waiting on an
+// account's lock make it hot
+const int ADMISSION_WINDOW = 32;
+const int HOT_ACCOUNT_WAITERS = 1;
+
 // Structure representing a ledger entry
 struct Ledger
 {
@@ -28,13 +35,34 @@ struct Ledger
 // External declaration of the ledger list
 extern list<struct Ledger> ledger;
 
+// Whether workers defer and coalesce entries for hot accounts (off by
+// default: no measured gain yet)
+extern bool admission_control;
+
+// Entries in flight per account (one runs, the rest wait for its lock), and
+// times the oldest entry has been deferred, used by admission control
+extern int *inflight;
+extern int front_skips;
+
 // Function to initialize the bank and set up worker threads
 void InitBank(int num_workers, char *filename);
 
+// Function to run a ledger on a given bank configuration (Bank, QuietBank,
+// LeanBank or SerialBank)
+template <class BankT>
+void RunLedger(int num_workers, char *filename);
+
 // Function to parse a ledger file and store each line into the ledger list
 void load_ledger(char *filename);
 
+// Function to take the next batch of ledger entries (ledger lock held)
+void admit(vector<struct Ledger> *batch);
+
+// Function to release the accounts of a finished batch (ledger lock held)
+void release(vector<struct Ledger> *batch);
+
 // Worker thread function
+template <class BankT>
 void *worker(void *unused);
 
 #endif
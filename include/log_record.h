@@ -0,0 +1,47 @@
+#ifndef _LOG_RECORD_H
+#define _LOG_RECORD_H
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+// Operations stored in a log record
+#define LOG_DEPOSIT 0
+#define LOG_WITHDRAW 1
+#define LOG_TRANSFER_OUT 2
+#define LOG_TRANSFER_IN 3
+#define LOG_CHECK_BALANCE 4
+
+// Outcomes stored in a log record
+#define LOG_SUCCESS 0
+#define LOG_FAILED 1
+
+// Structure representing one fixed-width entry of an account log
+struct LogRecord
+{
+	uint64_t timestamp;	  // Nanoseconds since the Unix epoch
+	int32_t amount;		  // Requested amount
+	int32_t counterparty; // Other account of a transfer, -1 otherwise
+	int32_t ledgerID;	  // Ledger entry ID
+	uint8_t op;			  // One of the LOG_* operations
+	uint8_t status;		  // LOG_SUCCESS or LOG_FAILED
+	uint16_t reserved;	  // Always 0
+};
+
+static_assert(sizeof(struct LogRecord) == 24, "log records must stay 24 bytes");
+
+// Function to fill in a log record stamped with the current time
+void make_log_record(struct LogRecord *rec, int op, int status, int amount, int counterparty, int ledgerID);
+
+// Function to render a log record in the text log format (without newline)
+string render_log_record(const struct LogRecord *rec);
+
+// Function to append a log record to a log file
+void write_log_record(fstream *file, const struct LogRecord *rec);
+
+// Function to read the next log record from a log stream, false at the end
+bool read_log_record(istream *file, struct LogRecord *rec);
+
+#endif
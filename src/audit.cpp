@@ -0,0 +1,142 @@
+#include <audit.h>
+
+using namespace std;
+
+/*
+ * The kernels below are plain loops over contiguous columns. This file is
+ * built with -O3 (see the Makefile), where GCC vectorizes the sum and the
+ * negative count for baseline x86-64. Baseline x86-64 has no 64-bit
+ * compare, so min/max also has SSE4.2 and AVX2 builds, picked per call
+ * from the CPU's features. (target_clones would pick at load time, but its
+ * resolver runs before sanitizer runtimes start and crashes TSan builds.)
+ */
+
+// min/max loop, inlined into each instruction set's build below
+static inline void min_max_loop(const long *column, int n, long *min_out, long *max_out)
+{
+	long lo = column[0], hi = column[0];
+	for (int i = 1; i < n; i++)
+	{
+		lo = column[i] < lo ? column[i] : lo;
+		hi = column[i] > hi ? column[i] : hi;
+	}
+	*min_out = lo;
+	*max_out = hi;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+__attribute__((target("avx2"))) static void audit_min_max_avx2(const long *column, int n, long *min_out, long *max_out)
+{
+	min_max_loop(column, n, min_out, max_out);
+}
+
+__attribute__((target("sse4.2"))) static void audit_min_max_sse42(const long *column, int n, long *min_out, long *max_out)
+{
+	min_max_loop(column, n, min_out, max_out);
+}
+#endif
+
+/**
+ * @brief Sums a column
+ *
+ * @param column the values to add up
+ * @param n the number of values
+ * @return long the sum
+ */
+long audit_sum(const long *column, int n)
+{
+	long sum = 0;
+	for (int i = 0; i < n; i++)
+	{
+		sum += column[i];
+	}
+	return sum;
+}
+
+/**
+ * @brief Finds the smallest and largest value of a column
+ *
+ * @param column the values to scan
+ * @param n the number of values (0 gives min = max = 0)
+ * @param min_out where to store the minimum
+ * @param max_out where to store the maximum
+ */
+void audit_min_max(const long *column, int n, long *min_out, long *max_out)
+{
+	if (n == 0)
+	{
+		*min_out = *max_out = 0;
+		return;
+	}
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (__builtin_cpu_supports("avx2"))
+	{
+		audit_min_max_avx2(column, n, min_out, max_out);
+		return;
+	}
+	if (__builtin_cpu_supports("sse4.2"))
+	{
+		audit_min_max_sse42(column, n, min_out, max_out);
+		return;
+	}
+#endif
+	min_max_loop(column, n, min_out, max_out);
+}
+
+/**
+ * @brief Counts the negative values of a column
+ *
+ * @param column the values to scan
+ * @param n the number of values
+ * @return long the number of values below zero
+ */
+long audit_count_negative(const long *column, int n)
+{
+	long count = 0;
+	for (int i = 0; i < n; i++)
+	{
+		count += (unsigned long)column[i] >> 63; // sign bit, no compare needed
+	}
+	return count;
+}
+
+/**
+ * @brief Takes a consistent snapshot of the bank and audits it
+ *
+ * Balances, deposits and withdrawals are copied into the bank's reusable
+ * columns, then reduced. Money is conserved when everything deposited minus everything
+ * withdrawn equals the sum of the balances (transfers cancel out).
+ *
+ * @param bank the bank to audit
+ * @param report where to store the result
+ * @return int 0 if the books balance and no account is negative, -1 otherwise
+ */
+int audit_bank(BankCore *bank, struct AuditReport *report)
+{
+	int n = bank->size();								// number of accounts
+	struct BalanceColumns *cols = bank->lock_columns(); // reusable columns
+	report->version = bank->snapshot(cols);				// consistent copy
+
+	report->total = audit_sum(cols->balance, n);
+	audit_min_max(cols->balance, n, &report->min_balance, &report->max_balance);
+	report->negatives = audit_count_negative(cols->balance, n);
+	report->deposited = audit_sum(cols->deposited, n);
+	report->withdrawn = audit_sum(cols->withdrawn, n);
+	report->conserved = report->deposited - report->withdrawn == report->total;
+	bank->unlock_columns(); // let the next audit reuse the columns
+
+	return report->conserved && report->negatives == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Prints an audit report
+ *
+ * @param report the report to print
+ */
+void print_audit(struct AuditReport *report)
+{
+	cout << "Audit: total " << report->total << " deposited " << report->deposited
+		 << " withdrawn " << report->withdrawn << " min " << report->min_balance
+		 << " max " << report->max_balance << " negatives " << report->negatives
+		 << (report->conserved ? " OK" : " MISMATCH") << endl;
+}
@@ -1,17 +1,19 @@
 #include <bank.h>
+#include <sched.h> /* for sched_yield() */
 
 /**
  * @brief prints account information
  */
-void Bank::print_account()
+void BankCore::print_account()
 {
+  Snapshot snap;
+  open_snapshot(&snap); // take a point-in-time view
   for (int i = 0; i < num; i++)
   {
-    accounts[i].lock_read(); // lock read
-    cout << "ID# " << accounts[i].accountID << " | " << accounts[i].balance
-         << endl;              // print account info
-    accounts[i].unlock_read(); // unlock read
+    cout << "ID# " << accounts[i].accountID << " | " << read_balance(i, &snap)
+         << endl; // print account info
   }
+  close_snapshot(&snap); // release the view
 
   pthread_mutex_lock(&bank_lock);                                    // lock bank
   cout << "Success: " << num_succ << " Fails: " << num_fail << endl; // print success and fails
@@ -19,35 +21,7 @@ void Bank::print_account()
 }
 
 /**
- * @brief helper function to increment the bank variable `num_fail` and log
- *        message.
- *
- * @param message
- */
-void Bank::recordFail(char *message)
-{
-  pthread_mutex_lock(&bank_lock);   // lock bank
-  cout << message << endl;          // print message
-  num_fail++;                       // increment fails
-  pthread_mutex_unlock(&bank_lock); // unlock bank
-}
-
-/**
- * @brief helper function to increment the bank variable `num_succ` and log
- *        message.
- *
- * @param message
- */
-void Bank::recordSucc(char *message)
-{
-  pthread_mutex_lock(&bank_lock);   // lock bank
-  cout << message << endl;          // print message
-  num_succ++;                       // increment success
-  pthread_mutex_unlock(&bank_lock); // unlock bank
-}
-
-/**
- * @brief Construct a new Bank:: Bank object.
+ * @brief Construct a new BankCore:: BankCore object.
  *
  * Requirements:
  *  - The function should initialize the private variables.
@@ -57,18 +31,37 @@ void Bank::recordSucc(char *message)
  *  - Initialize each account log (HINT: there are two fields to initialize)
  *
  * @param N
+ * @param versioned whether writers publish balance versions
  */
-Bank::Bank(int N)
+BankCore::BankCore(int N, bool versioned) : versioned(versioned)
 {
   pthread_mutex_init(&bank_lock, NULL);              // initialize bank lock
+  pthread_mutex_init(&columns_lock, NULL);           // initialize columns lock
+  columns.balance = NULL;                            // columns are allocated by the first audit
+  columns.deposited = NULL;                          // columns are allocated by the first audit
+  columns.withdrawn = NULL;                          // columns are allocated by the first audit
   num = N;                                           // set num to N
   num_succ = 0;                                      // set num_succ to 0
   num_fail = 0;                                      // set num_fail to 0
+  next_ts = 0;                                       // no commits yet
+  visible_ts = 0;                                    // no commits yet
+  for (int i = 0; i < COMMIT_RING; i++)
+  {
+    commit_done[i] = 0; // no finished commits
+  }
+  for (int i = 0; i < MAX_SNAPSHOTS; i++)
+  {
+    reader_epochs[i] = EPOCH_IDLE; // no open snapshots
+  }
   accounts = (Account *)malloc(N * sizeof(Account)); // allocate memory for accounts
   for (int i = 0; i < N; i++)
   {
     accounts[i].accountID = i;                          // set accountID to i
     accounts[i].balance = 0;                            // set balance to 0
+    accounts[i].deposited = 0;                          // set deposited to 0
+    accounts[i].withdrawn = 0;                          // set withdrawn to 0
+    accounts[i].head = NULL;                            // no versions yet
+    accounts[i].spare = NULL;                           // no spare versions yet
     accounts[i].read_count = 0;                         // set read_count to 0
     accounts[i].write_lock = PTHREAD_MUTEX_INITIALIZER; // initialize write_lock
     accounts[i].read_lock = PTHREAD_MUTEX_INITIALIZER;  // initialize read_lock
@@ -82,28 +75,94 @@ Bank::Bank(int N)
 }
 
 /**
- * @brief Destroy the Bank:: Bank object
+ * @brief Destroy the BankCore:: BankCore object
  *
  * Requirements:
  *  - Make sure to destroy all locks.
  *  - Make sure to free all memory
  *
  */
-Bank::~Bank()
+BankCore::~BankCore()
 {
   for (int i = 0; i < num; i++)
   {
     pthread_mutex_destroy(&accounts[i].read_lock);  // destroy read_lock
     pthread_mutex_destroy(&accounts[i].write_lock); // destroy write_lock
+    while (accounts[i].head != NULL)                // free versions
+    {
+      BalanceVersion *v = accounts[i].head;
+      accounts[i].head = v->prev;
+      free(v);
+    }
+    while (accounts[i].spare != NULL) // free spare versions
+    {
+      BalanceVersion *v = accounts[i].spare;
+      accounts[i].spare = v->prev;
+      free(v);
+    }
   }
   for (int i = 0; i < num; i++)
   {
     pthread_mutex_destroy(&accountLogs[i].read_lock);  // destroy read_lock
     pthread_mutex_destroy(&accountLogs[i].write_lock); // destroy write_lock
   }
-  free(accounts);                    // free memory
-  free(accountLogs);                 // free memory
-  pthread_mutex_destroy(&bank_lock); // destroy bank_lock
+  free(accounts);                       // free memory
+  free(accountLogs);                    // free memory
+  free(columns.balance);                // free audit columns
+  free(columns.deposited);              // free audit columns
+  free(columns.withdrawn);              // free audit columns
+  pthread_mutex_destroy(&columns_lock); // destroy columns_lock
+  pthread_mutex_destroy(&bank_lock);    // destroy bank_lock
+}
+
+/**
+ * @brief helper function to increment the bank variable `num_fail` and log
+ *        message.
+ *
+ * @param message callable returning the message, only called if printed
+ */
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+template <class Message>
+void BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::recordFail(Message message)
+{
+  if constexpr (StatsPolicy::count || StatsPolicy::print)
+  {
+    LockPolicy::lock(&bank_lock); // lock bank
+    if constexpr (StatsPolicy::print)
+    {
+      cout << message() << endl; // print message
+    }
+    if constexpr (StatsPolicy::count)
+    {
+      num_fail++; // increment fails
+    }
+    LockPolicy::unlock(&bank_lock); // unlock bank
+  }
+}
+
+/**
+ * @brief helper function to increment the bank variable `num_succ` and log
+ *        message.
+ *
+ * @param message callable returning the message, only called if printed
+ */
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+template <class Message>
+void BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::recordSucc(Message message)
+{
+  if constexpr (StatsPolicy::count || StatsPolicy::print)
+  {
+    LockPolicy::lock(&bank_lock); // lock bank
+    if constexpr (StatsPolicy::print)
+    {
+      cout << message() << endl; // print message
+    }
+    if constexpr (StatsPolicy::count)
+    {
+      num_succ++; // increment success
+    }
+    LockPolicy::unlock(&bank_lock); // unlock bank
+  }
 }
 
 /**
@@ -118,29 +177,83 @@ Bank::~Bank()
  * @param accountID the account ID to deposit
  * @param amount the amount deposited
  * @param file the file to write the log to
- * @return int
+ * @return int 0 on success -1 on error
+ */
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+int BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::deposit(int workerID, int ledgerID, int accountID, int amount, fstream *file)
+{
+  if (amount < 0) // nothing to deposit
+  {
+    return -1;
+  }
+  LockPolicy::lock_write(&accounts[accountID]); // lock account
+  accounts[accountID].balance += amount;        // add amount to balance
+  accounts[accountID].deposited += amount;      // record deposit for audits
+  if constexpr (VersionPolicy::enabled)
+  {
+    publish(accountID); // publish new version
+  }
+  if constexpr (LogPolicy::enabled)
+  {
+    LogRecord rec;                                                         // create log record
+    make_log_record(&rec, LOG_DEPOSIT, LOG_SUCCESS, amount, -1, ledgerID); // fill in log record
+    LockPolicy::lock_write(&accountLogs[accountID]);                       // lock account log
+    LogPolicy::write(file, &rec);                                          // write log to file
+    LockPolicy::unlock_write(&accountLogs[accountID]);                     // unlock account log
+  }
+  recordSucc([&]
+             { return "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": deposit " + to_string(amount) + " into account " + to_string(accountID); }); // log success
+  LockPolicy::unlock_write(&accounts[accountID]);                                                                                                                               // unlock account
+  return 0;                                                                                                                                                                     // return 0
+}
+
+/**
+ * @brief Adds several queued deposits to one account under a single lock
+ *
+ * The balance is updated and published once; every deposit still gets its
+ * own log record and success message.
+ *
+ * @param workerID the ID of the worker (thread)
+ * @param count the number of deposits
+ * @param ledgerIDs the ID of each ledger entry
+ * @param accountID the account ID to deposit
+ * @param amounts the amount of each deposit (all >= 0)
+ * @param file the file to write the log to
+ * @return int 0 on success
  */
-int Bank::deposit(int workerID, int ledgerID, int accountID, int amount, fstream *file)
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+int BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::deposit_many(int workerID, int count, const int *ledgerIDs, int accountID, const int *amounts, fstream *file)
 {
-  if (amount >= 0)
-  {
-    accounts[accountID].lock_write();                                                                                                                                       // lock account
-    accounts[accountID].balance += amount;                                                                                                                                  // add amount to balance
-    string str = "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": deposit " + to_string(amount) + " into account " + to_string(accountID); // create log message
-    string log = "Transaction Type: Deposit, Amount: " + to_string(amount) + ", Status: Success\n";                                                                         // create log message
-    char message[str.length() + 1];                                                                                                                                         // create char array
-    message[str.length()] = '\0';
-    for (int i = 0; i < str.length(); i++)
+  long total = 0; // combined amount
+  for (int i = 0; i < count; i++)
+  {
+    total += amounts[i];
+  }
+  LockPolicy::lock_write(&accounts[accountID]); // lock account
+  accounts[accountID].balance += total;         // add combined amount to balance
+  accounts[accountID].deposited += total;       // record deposits for audits
+  if constexpr (VersionPolicy::enabled)
+  {
+    publish(accountID); // publish one new version
+  }
+  if constexpr (LogPolicy::enabled)
+  {
+    LockPolicy::lock_write(&accountLogs[accountID]); // lock account log
+    for (int i = 0; i < count; i++)
     {
-      message[i] = str[i]; // copy string to char array
+      LogRecord rec;                                                                 // create log record
+      make_log_record(&rec, LOG_DEPOSIT, LOG_SUCCESS, amounts[i], -1, ledgerIDs[i]); // fill in log record
+      LogPolicy::write(file, &rec);                                                  // write log to file
     }
-    accountLogs[accountID].lock_write();   // lock account log
-    *file << log;                          // write log to file
-    accountLogs[accountID].unlock_write(); // unlock account log
-    recordSucc(message);                   // log success
-    accounts[accountID].unlock_write();    // unlock account
-    return 0;                              // return 0
+    LockPolicy::unlock_write(&accountLogs[accountID]); // unlock account log
   }
+  LockPolicy::unlock_write(&accounts[accountID]); // unlock account
+  for (int i = 0; i < count; i++)
+  {
+    recordSucc([&]
+               { return "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerIDs[i]) + ": deposit " + to_string(amounts[i]) + " into account " + to_string(accountID); }); // log success
+  }
+  return 0;
 }
 
 /**
@@ -158,45 +271,40 @@ int Bank::deposit(int workerID, int ledgerID, int accountID, int amount, fstream
  * @param file the file to write the log to
  * @return int 0 on success -1 on failure
  */
-int Bank::withdraw(int workerID, int ledgerID, int accountID, int amount, fstream *file)
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+int BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::withdraw(int workerID, int ledgerID, int accountID, int amount, fstream *file)
 {
-  accounts[accountID].lock_write();                        // lock account
-  if (accounts[accountID].balance > amount && amount >= 0) // check if balance is greater than amount
-  {
-    accounts[accountID].balance -= amount;                                                                                                                                   // subtract amount from balance
-    string str = "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": withdraw " + to_string(amount) + " from account " + to_string(accountID); // create log message
-    *file << "Transaction Type: Withdraw, Amount: " + to_string(amount) + ", Status: Success" << endl;                                                                       // write log to file
-    char message[str.length() + 1];                                                                                                                                          // create char array
-    message[str.length()] = '\0';                                                                                                                                            // set last char to null
-    for (int i = 0; i < str.length(); i++)
+  LockPolicy::lock_write(&accounts[accountID]);                   // lock account
+  bool ok = accounts[accountID].balance > amount && amount >= 0; // check if balance is greater than amount
+  if (ok)
+  {
+    accounts[accountID].balance -= amount;   // subtract amount from balance
+    accounts[accountID].withdrawn += amount; // record withdrawal for audits
+    if constexpr (VersionPolicy::enabled)
     {
-      message[i] = str[i]; // copy string to char array
+      publish(accountID); // publish new version
     }
-    string log = "Transaction Type: Withdraw, Amount: 0, Status: Failed\n"; // create log message
-    accountLogs[accountID].lock_write();                                    // lock account log
-    *file << log;                                                           // write log to file
-    accountLogs[accountID].unlock_write();                                  // unlock account log
-    recordSucc(message);                                                    // log success
-    accounts[accountID].unlock_write();                                     // unlock account
+  }
+  if constexpr (LogPolicy::enabled)
+  {
+    LogRecord rec;                                                                           // create log record
+    make_log_record(&rec, LOG_WITHDRAW, ok ? LOG_SUCCESS : LOG_FAILED, amount, -1, ledgerID); // fill in log record
+    LockPolicy::lock_write(&accountLogs[accountID]);                                         // lock account log
+    LogPolicy::write(file, &rec);                                                            // write log to file
+    LockPolicy::unlock_write(&accountLogs[accountID]);                                       // unlock account log
+  }
+  if (ok)
+  {
+    recordSucc([&]
+               { return "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": withdraw " + to_string(amount) + " from account " + to_string(accountID); }); // log success
   }
   else
   {
-    string str = "Worker " + to_string(workerID) + " failed to complete ledger " + to_string(ledgerID) + ": withdraw " + to_string(amount) + " from account " + to_string(accountID); // create log message
-    char message[str.length() + 1];                                                                                                                                                   // create char array
-    message[str.length()] = '\0';                                                                                                                                                     // set last char to null
-    for (int i = 0; i < str.length(); i++)
-    {
-      message[i] = str[i]; // copy string to char array
-    }
-    string log = "Transaction Type: Withdraw, Amount: 0, Status: Failed\n"; // create log message
-    accountLogs[accountID].lock_write();                                    // lock account log
-    *file << log;                                                           // write log to file
-    accountLogs[accountID].unlock_write();                                  // unlock account log
-    recordFail(message);                                                    // log failure
-    accounts[accountID].unlock_write();                                     // unlock account
-    return -1;                                                              // return -1
-  }
-  return 0; // return 0
+    recordFail([&]
+               { return "Worker " + to_string(workerID) + " failed to complete ledger " + to_string(ledgerID) + ": withdraw " + to_string(amount) + " from account " + to_string(accountID); }); // log failure
+  }
+  LockPolicy::unlock_write(&accounts[accountID]); // unlock account
+  return ok ? 0 : -1;                             // return 0 on success, -1 on failure
 }
 
 /**
@@ -216,56 +324,54 @@ int Bank::withdraw(int workerID, int ledgerID, int accountID, int amount, fstrea
  * @param file2 the file to write the log to (for the destination account)
  * @return int 0 on success -1 on error
  */
-int Bank::transfer(int workerID, int ledgerID, int srcID, int destID,
-                   unsigned int amount, fstream *file, fstream *file2)
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+int BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::transfer(int workerID, int ledgerID, int srcID, int destID,
+                                                                           unsigned int amount, fstream *file, fstream *file2)
 {
-  accounts[srcID].lock_write();                                           // lock source account
-  if (accounts[srcID].balance > amount && srcID != destID && amount >= 0) // check if source account has enough money
-  {
-    accounts[srcID].balance -= amount;                                                                                                                                                                        // subtract amount from source account
-    accounts[destID].lock_write();                                                                                                                                                                            // lock destination account
-    accounts[destID].balance += amount;                                                                                                                                                                       // add amount to destination account
-    accounts[destID].unlock_write();                                                                                                                                                                          // unlock destination account
-    string str = "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": transfer " + to_string(amount) + " from account " + to_string(srcID) + " to account " + to_string(destID); // create log message
-    char message[str.length() + 1];                                                                                                                                                                           // create char array
-    message[str.length()] = '\0';                                                                                                                                                                             // set last char to null
-    for (int i = 0; i < str.length(); i++)                                                                                                                                                                    // copy string to char array
+  LockPolicy::lock_write(&accounts[min(srcID, destID)]); // lock the lower account first so transfers cannot deadlock
+  if (srcID != destID)
+  {
+    LockPolicy::lock_write(&accounts[max(srcID, destID)]); // lock the higher account
+  }
+  bool ok = accounts[srcID].balance > amount && srcID != destID; // check if source account has enough money
+  if (ok)
+  {
+    accounts[srcID].balance -= amount;  // subtract amount from source account
+    accounts[destID].balance += amount; // add amount to destination account
+    if constexpr (VersionPolicy::enabled)
     {
-      message[i] = str[i]; // copy string to char array
+      publish(srcID, destID); // publish both versions at once
     }
-    recordSucc(message);                                                                                                                   // log success
-    string log1 = "Transaction Type: Transfer, Amount: " + to_string(amount) + ", Receiver: " + to_string(destID) + ", Status: Success\n"; // create log message
-    string log2 = "Transaction Type: Transfer, Amount: " + to_string(amount) + ", Sender: " + to_string(srcID) + ", Status: Success\n";    // create log message
-    accountLogs[srcID].lock_write();                                                                                                       // lock source account log
-    *file << log1;                                                                                                                         // write log to file
-    accountLogs[srcID].unlock_write();                                                                                                     // unlock source account log
-    accountLogs[destID].lock_write();                                                                                                      // lock destination account log
-    *file2 << log2;                                                                                                                        // write log to file
-    accountLogs[destID].unlock_write();                                                                                                    // unlock destination account log
-    accounts[srcID].unlock_write();                                                                                                        // unlock source account
+  }
+  if (srcID != destID)
+  {
+    LockPolicy::unlock_write(&accounts[destID]); // unlock destination account
+  }
+  if (ok)
+  {
+    recordSucc([&]
+               { return "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": transfer " + to_string(amount) + " from account " + to_string(srcID) + " to account " + to_string(destID); }); // log success
   }
   else
   {
-    string str = "Worker " + to_string(workerID) + " failed to complete ledger " + to_string(ledgerID) + ": transfer " + to_string(amount) + " from account " + to_string(srcID) + " to account " + to_string(destID); // create log message
-    char message[str.length() + 1];                                                                                                                                                                                    // create char array
-    message[str.length()] = '\0';                                                                                                                                                                                      // set last char to null
-    for (int i = 0; i < str.length(); i++)                                                                                                                                                                             // copy string to char array
-    {
-      message[i] = str[i]; // copy string to char array
-    }
-    recordFail(message);
-    string log1 = "Transaction Type: Transfer, Amount: 0, Receiver: " + to_string(destID) + ", Status: Failed\n"; // create log message
-    string log2 = "Transaction Type: Transfer, Amount: 0, Sender: " + to_string(srcID) + ", Status: Failed\n";    // create log message
-    accountLogs[srcID].lock_write();                                                                              // lock source account log
-    *file << log1;                                                                                                // write log to file
-    accountLogs[srcID].unlock_write();                                                                            // unlock source account log
-    accountLogs[destID].lock_write();                                                                             // lock destination account log
-    *file2 << log2;                                                                                               // write log to file
-    accountLogs[destID].unlock_write();                                                                           // unlock destination account log
-    accounts[srcID].unlock_write();                                                                               // unlock source account
-    return -1;                                                                                                    // return -1
-  }
-  return 0; // return 0
+    recordFail([&]
+               { return "Worker " + to_string(workerID) + " failed to complete ledger " + to_string(ledgerID) + ": transfer " + to_string(amount) + " from account " + to_string(srcID) + " to account " + to_string(destID); }); // log failure
+  }
+  if constexpr (LogPolicy::enabled)
+  {
+    int status = ok ? LOG_SUCCESS : LOG_FAILED;
+    LogRecord rec1, rec2;                                                         // create log records
+    make_log_record(&rec1, LOG_TRANSFER_OUT, status, amount, destID, ledgerID); // fill in source log record
+    make_log_record(&rec2, LOG_TRANSFER_IN, status, amount, srcID, ledgerID);   // fill in destination log record
+    LockPolicy::lock_write(&accountLogs[srcID]);                                // lock source account log
+    LogPolicy::write(file, &rec1);                                              // write log to file
+    LockPolicy::unlock_write(&accountLogs[srcID]);                              // unlock source account log
+    LockPolicy::lock_write(&accountLogs[destID]);                               // lock destination account log
+    LogPolicy::write(file2, &rec2);                                             // write log to file
+    LockPolicy::unlock_write(&accountLogs[destID]);                             // unlock destination account log
+  }
+  LockPolicy::unlock_write(&accounts[srcID]); // unlock source account
+  return ok ? 0 : -1;                         // return 0 on success, -1 on error
 }
 
 /**
@@ -281,26 +387,39 @@ int Bank::transfer(int workerID, int ledgerID, int srcID, int destID,
  * @param file the file to write the log to
  * @return int 0 on success -1 on error
  */
-int Bank::check_balance(int workerID, int ledgerID, int accountID, fstream *file)
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+int BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::check_balance(int workerID, int ledgerID, int accountID, fstream *file)
 {
-  accounts[accountID].lock_read();                                                                                                                  // lock account
-  int balance = accounts[accountID].balance;                                                                                                        // get balance
-  pthread_mutex_lock(&bank_lock);                                                                                                                   // lock bank
-  cout << "Account " << accountID << " - Balance: " << balance << endl;                                                                             // print balance
-  pthread_mutex_unlock(&bank_lock);                                                                                                                 // unlock bank
-  string str = "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": check balance of account " + to_string(accountID); // create log message
-  char message[str.length() + 1];                                                                                                                   // create char array
-  message[str.length()] = '\0';                                                                                                                     // set last char to null
-  for (int i = 0; i < str.length(); i++)
-  {
-    message[i] = str[i]; // copy string to char array
-  }
-  recordSucc(message);                                                          // log success
-  string log = "Transaction Type: Check Balance, Amount: 0, Status: Success\n"; // create log message
-  accountLogs[accountID].lock_write();                                          // lock account log
-  *file << log;                                                                 // write log to file
-  accountLogs[accountID].unlock_write();                                        // unlock account log
-  accounts[accountID].unlock_read();                                            // unlock account
+  long balance;
+  if constexpr (VersionPolicy::enabled)
+  {
+    Snapshot snap;                            // point-in-time view
+    open_snapshot(&snap);                     // take the view
+    balance = read_balance(accountID, &snap); // get balance
+    close_snapshot(&snap);                    // release the view
+  }
+  else
+  {
+    LockPolicy::lock_read(&accounts[accountID]);   // lock account for reading
+    balance = accounts[accountID].balance;         // get balance
+    LockPolicy::unlock_read(&accounts[accountID]); // unlock account
+  }
+  if constexpr (StatsPolicy::print)
+  {
+    LockPolicy::lock(&bank_lock);                                         // lock bank
+    cout << "Account " << accountID << " - Balance: " << balance << endl; // print balance
+    LockPolicy::unlock(&bank_lock);                                       // unlock bank
+  }
+  recordSucc([&]
+             { return "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": check balance of account " + to_string(accountID); }); // log success
+  if constexpr (LogPolicy::enabled)
+  {
+    LogRecord rec;                                                          // create log record
+    make_log_record(&rec, LOG_CHECK_BALANCE, LOG_SUCCESS, 0, -1, ledgerID); // fill in log record
+    LockPolicy::lock_write(&accountLogs[accountID]);                        // lock account log
+    LogPolicy::write(file, &rec);                                           // write log to file
+    LockPolicy::unlock_write(&accountLogs[accountID]);                      // unlock account log
+  }
   return 0;
 }
 
@@ -310,47 +429,358 @@ int Bank::check_balance(int workerID, int ledgerID, int accountID, fstream *file
  * Requirements:
  * - Log the success or failure
  *
+ * The binary log records are rendered in the text log format. Nothing is
+ * printed unless both logging and console output are compiled in.
  *
  * @param workerID the ID of the worker (thread)
  * @param ledgerID the ID of the ledger entry
  * @param accountID the account ID to print balance of
+ * @param file the binary log file of the account
  * @return int 0 on success -1 on error
  */
-int Bank::printAccountLog(int workerID, int ledgerID, int accountID, fstream *file)
+template <class LockPolicy, class LogPolicy, class StatsPolicy, class VersionPolicy>
+int BasicBank<LockPolicy, LogPolicy, StatsPolicy, VersionPolicy>::printAccountLog(int workerID, int ledgerID, int accountID, fstream *file)
 {
-  string line;           // string to hold each line of the file
-  if ((*file).is_open()) // if the file is open
+  if constexpr (LogPolicy::enabled)
   {
-    accountLogs[accountID].lock_read(); // lock account log
-    while (getline(*file, line))        // while there are lines to read
+    if (!(*file).is_open()) // if the file is not open
+    {
+      recordFail([&]
+                 { return "Worker " + to_string(workerID) + " failed to completed ledger " + to_string(ledgerID) + ": print account log of account " + to_string(accountID); }); // log error
+      return -1;                                                                                                                                                           // Indicate failure
+    }
+  }
+  if constexpr (LogPolicy::enabled && StatsPolicy::print)
+  {
+    vector<LogRecord> records; // records read from the file
+    LogRecord rec;             // record being read
+    // reading moves the shared stream position, so keep writers and other
+    // readers out until the write position is restored
+    LockPolicy::lock_write(&accountLogs[accountID]); // lock account log
+    file->flush();                                   // push buffered records to the file
+    streampos end = file->tellp();                   // remember where appends go
+    file->seekg(0);                                  // read from the start
+    while (read_log_record(file, &rec))              // while there are records to read
+    {
+      records.push_back(rec);
+    }
+    file->clear();                                     // clear end of file
+    file->seekp(end);                                  // restore the write position
+    LockPolicy::unlock_write(&accountLogs[accountID]); // unlock account log
+    LockPolicy::lock(&bank_lock);                      // lock bank
+    for (size_t i = 0; i < records.size(); i++)
     {
-      accountLogs[accountID].unlock_read(); // unlock account log
-      pthread_mutex_lock(&bank_lock);       // lock bank
-      cout << line << '\n';                 // print line
-      pthread_mutex_unlock(&bank_lock);     // unlock bank
-      accountLogs[accountID].lock_read();   // lock account log
+      cout << render_log_record(&records[i]) << '\n'; // print record as text
     }
-    accountLogs[accountID].unlock_read(); // unlock account log
+    LockPolicy::unlock(&bank_lock); // unlock bank
+  }
+  recordSucc([&]
+             { return "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": print account log of account " + to_string(accountID); }); // log success
+  return 0;                                                                                                                                                      // Indicate success
+}
+
+/**
+ * @brief Publishes the current values of one or two accounts as a new
+ *        version, visible to snapshots as a single commit.
+ *
+ * The caller must hold the write lock of every account passed in. Commit
+ * timestamps are handed out in order and made visible in the same order,
+ * so a snapshot never sees a later commit without all earlier ones.
+ *
+ * A writer never waits for earlier commits: it marks its own commit
+ * finished and advances `visible_ts` over every finished commit it finds.
+ * If an earlier writer is preempted mid-commit, later commits simply stay
+ * invisible until it finishes. Only when COMMIT_RING commits are pending
+ * does a new writer wait for visibility to catch up.
+ *
+ * @param accountID the first account updated
+ * @param dest the second account updated, or -1
+ */
+void BankCore::publish(int accountID, int dest)
+{
+  unsigned long ts = __atomic_add_fetch(&next_ts, 1, __ATOMIC_SEQ_CST); // take a commit timestamp
+  while (ts - __atomic_load_n(&visible_ts, __ATOMIC_ACQUIRE) > COMMIT_RING) // ring full, rare
+  {
+    sched_yield();
+  }
+  install(accountID, ts); // new version for the account
+  if (dest >= 0)
+  {
+    install(dest, ts); // new version for the destination, same commit
+  }
+  __atomic_store_n(&commit_done[ts % COMMIT_RING], ts, __ATOMIC_SEQ_CST); // mark the commit finished
+  advance_visible();                                                       // make finished commits visible
+  reclaim(accountID);                                                      // recycle versions nobody can see
+  if (dest >= 0)
+  {
+    reclaim(dest);
+  }
+}
+
+/**
+ * @brief Pushes a version holding the account's current values on top of
+ *        its version chain.
+ *
+ * @param accountID the account to version
+ * @param ts the commit timestamp of the version
+ */
+void BankCore::install(int accountID, unsigned long ts)
+{
+  BalanceVersion *v = accounts[accountID].spare; // reuse a reclaimed version
+  if (v != NULL)
+  {
+    accounts[accountID].spare = v->prev;
   }
   else
   {
-    string str = "Worker " + to_string(workerID) + " failed to completed ledger " + to_string(ledgerID) + ": print account log of account " + to_string(accountID); // create log message
-    char message[str.length() + 1];                                                                                                                                 // create char array
-    message[str.length()] = '\0';                                                                                                                                   // set last char to null
-    for (int i = 0; i < str.length(); i++)                                                                                                                          // copy string to char array
+    v = (BalanceVersion *)malloc(sizeof(BalanceVersion)); // allocate version
+  }
+  v->balance = accounts[accountID].balance;
+  v->deposited = accounts[accountID].deposited;
+  v->withdrawn = accounts[accountID].withdrawn;
+  v->ts = ts;
+  v->prev = accounts[accountID].head;
+  __atomic_store_n(&accounts[accountID].head, v, __ATOMIC_RELEASE); // readers may now find it
+}
+
+/**
+ * @brief Moves `visible_ts` forward over every consecutive finished commit.
+ *
+ * Each writer stores its own slot before calling this, so of two writers
+ * finishing next to each other at least one sees the other's slot.
+ */
+void BankCore::advance_visible()
+{
+  unsigned long v = __atomic_load_n(&visible_ts, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&commit_done[(v + 1) % COMMIT_RING], __ATOMIC_SEQ_CST) == v + 1) // next commit finished
+  {
+    if (__atomic_compare_exchange_n(&visible_ts, &v, v + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+      v++; // we advanced it
+    }
+  }
+}
+
+/**
+ * @brief Returns the oldest epoch an open snapshot may still read at.
+ *
+ * `visible_ts` is read before the slots: a reader whose announcement we
+ * miss reads `visible_ts` after us, so its epoch is at least our bound. A
+ * slot that is claimed but not yet announced blocks reclamation entirely.
+ *
+ * @return unsigned long the oldest epoch in use, 0 if unknown
+ */
+unsigned long BankCore::oldest_epoch()
+{
+  unsigned long oldest = __atomic_load_n(&visible_ts, __ATOMIC_SEQ_CST);
+  for (int i = 0; i < MAX_SNAPSHOTS; i++)
+  {
+    unsigned long e = __atomic_load_n(&reader_epochs[i], __ATOMIC_SEQ_CST);
+    if (e == EPOCH_PENDING)
+    {
+      return 0;
+    }
+    oldest = e < oldest ? e : oldest;
+  }
+  return oldest;
+}
+
+/**
+ * @brief Recycles the versions of an account that no open or future
+ *        snapshot can reach onto its spare list.
+ *
+ * Every snapshot reads at an epoch of at least `oldest_epoch()`, so it
+ * stops at the newest version committed at or before that epoch and never
+ * follows the chain below it. The caller must hold the account's write lock.
+ *
+ * @param accountID the account to trim
+ */
+void BankCore::reclaim(int accountID)
+{
+  unsigned long oldest = oldest_epoch();
+  BalanceVersion *v = accounts[accountID].head;
+  while (v != NULL && v->ts > oldest) // find the oldest version still needed
+  {
+    v = v->prev;
+  }
+  if (v == NULL || v->prev == NULL) // nothing to free
+  {
+    return;
+  }
+  BalanceVersion *old = v->prev;
+  __atomic_store_n(&v->prev, (BalanceVersion *)NULL, __ATOMIC_RELEASE); // detach older versions
+  while (old != NULL)                                                    // unreachable, reuse right away
+  {
+    BalanceVersion *next = old->prev;
+    old->prev = accounts[accountID].spare;
+    accounts[accountID].spare = old;
+    old = next;
+  }
+}
+
+/**
+ * @brief Opens a point-in-time view of every account.
+ *
+ * No account lock is taken. The view's epoch is announced in a reader slot
+ * so writers keep the versions it needs until `close_snapshot`.
+ *
+ * @param snap the snapshot to open
+ */
+void BankCore::open_snapshot(Snapshot *snap)
+{
+  if (!versioned) // nothing to pin, reads see the live balances
+  {
+    snap->slot = -1;
+    snap->ts = 0;
+    return;
+  }
+  for (int i = 0;; i = (i + 1) % MAX_SNAPSHOTS) // claim a free slot
+  {
+    unsigned long idle = EPOCH_IDLE;
+    if (__atomic_compare_exchange_n(&reader_epochs[i], &idle, EPOCH_PENDING, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+      snap->slot = i;
+      break;
+    }
+    if (i == MAX_SNAPSHOTS - 1) // every slot busy
     {
-      message[i] = str[i]; // copy string to char array
+      sched_yield();
     }
-    recordFail(message); // log error
-    return -1;           // Indicate failure
   }
-  string str = "Worker " + to_string(workerID) + " completed ledger " + to_string(ledgerID) + ": print account log of account " + to_string(accountID); // create log message
-  char message[str.length() + 1];                                                                                                                       // create char array
-  message[str.length()] = '\0';                                                                                                                         // set last char to null
-  for (int i = 0; i < str.length(); i++)                                                                                                                // copy string to char array
+  snap->ts = __atomic_load_n(&visible_ts, __ATOMIC_SEQ_CST);               // latest visible commit
+  __atomic_store_n(&reader_epochs[snap->slot], snap->ts, __ATOMIC_SEQ_CST); // announce our epoch
+}
+
+/**
+ * @brief Closes a view opened with `open_snapshot`.
+ *
+ * @param snap the snapshot to close
+ */
+void BankCore::close_snapshot(Snapshot *snap)
+{
+  if (snap->slot < 0) // bank without versions
+  {
+    return;
+  }
+  __atomic_store_n(&reader_epochs[snap->slot], EPOCH_IDLE, __ATOMIC_RELEASE); // free the slot
+}
+
+/**
+ * @brief Finds the version of an account seen by a snapshot.
+ *
+ * @param accountID the account to read
+ * @param snap an open snapshot
+ * @return BalanceVersion* the version, NULL if the account was never
+ *         updated as of the snapshot (all values zero) or the bank keeps
+ *         no versions
+ */
+BalanceVersion *BankCore::read_version(int accountID, Snapshot *snap)
+{
+  BalanceVersion *v = __atomic_load_n(&accounts[accountID].head, __ATOMIC_ACQUIRE);
+  while (v != NULL && v->ts > snap->ts) // skip versions newer than the view
+  {
+    v = __atomic_load_n(&v->prev, __ATOMIC_ACQUIRE);
+  }
+  return v;
+}
+
+/**
+ * @brief Reads an account's balance as of a snapshot. A bank without
+ *        versions reads the live balance under the account's read lock.
+ *
+ * @param accountID the account to read
+ * @param snap an open snapshot
+ * @return long the balance
+ */
+long BankCore::read_balance(int accountID, Snapshot *snap)
+{
+  if (!versioned)
   {
-    message[i] = str[i]; // copy string to char array
+    accounts[accountID].lock_read(); // lock account for reading
+    long balance = accounts[accountID].balance;
+    accounts[accountID].unlock_read(); // unlock account
+    return balance;
   }
-  recordSucc(message); // log success
-  return 0;            // Indicate success
-}
\ No newline at end of file
+  BalanceVersion *v = read_version(accountID, snap);
+  return v == NULL ? 0 : v->balance;
+}
+
+/**
+ * @brief Copies a consistent snapshot of every account into the given
+ *        structure-of-arrays columns (each of length `size()`).
+ *
+ * Writers are never blocked: the copy is read from the version chains at a
+ * single commit timestamp. A bank without versions instead read-locks
+ * every account, in the same ascending order transfers lock in, and copies
+ * the live values, so writers wait for the copy.
+ *
+ * @param cols the columns to fill
+ * @return unsigned long the commit timestamp of the snapshot, 0 for a bank
+ *         without versions
+ */
+unsigned long BankCore::snapshot(struct BalanceColumns *cols)
+{
+  if (!versioned)
+  {
+    for (int i = 0; i < num; i++)
+    {
+      accounts[i].lock_read(); // hold every account for a consistent copy
+      cols->balance[i] = accounts[i].balance;
+      cols->deposited[i] = accounts[i].deposited;
+      cols->withdrawn[i] = accounts[i].withdrawn;
+    }
+    for (int i = 0; i < num; i++)
+    {
+      accounts[i].unlock_read();
+    }
+    return 0;
+  }
+  Snapshot snap;
+  open_snapshot(&snap);
+  for (int i = 0; i < num; i++)
+  {
+    BalanceVersion *v = __atomic_load_n(&accounts[i].head, __ATOMIC_ACQUIRE);
+    while (v != NULL && v->ts > snap.ts) // skip versions newer than the view
+    {
+      v = __atomic_load_n(&v->prev, __ATOMIC_ACQUIRE);
+    }
+    cols->balance[i] = v == NULL ? 0 : v->balance;
+    cols->deposited[i] = v == NULL ? 0 : v->deposited;
+    cols->withdrawn[i] = v == NULL ? 0 : v->withdrawn;
+  }
+  close_snapshot(&snap);
+  return snap.ts;
+}
+
+/**
+ * @brief Takes ownership of the bank's audit columns, allocating them the
+ *        first time. Release them with `unlock_columns`.
+ *
+ * @return BalanceColumns* columns of length `size()`
+ */
+BalanceColumns *BankCore::lock_columns()
+{
+  pthread_mutex_lock(&columns_lock); // one audit at a time
+  if (columns.balance == NULL)       // first audit
+  {
+    columns.balance = (long *)malloc(num * sizeof(long));
+    columns.deposited = (long *)malloc(num * sizeof(long));
+    columns.withdrawn = (long *)malloc(num * sizeof(long));
+  }
+  return &columns;
+}
+
+/**
+ * @brief Releases the columns taken with `lock_columns`.
+ */
+void BankCore::unlock_columns()
+{
+  pthread_mutex_unlock(&columns_lock);
+}
+
+// Bank configurations built into the library
+template class BasicBank<MutexLocking, BinaryLog, ConsoleStats, MultiVersion>;
+template class BasicBank<MutexLocking, BinaryLog, CountingStats, MultiVersion>;
+template class BasicBank<MutexLocking, NoLog, CountingStats, NoVersions>;
+template class BasicBank<NoLocking, NoLog, NoStats, NoVersions>;
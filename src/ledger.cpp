@@ -5,8 +5,12 @@ using namespace std;
 pthread_mutex_t ledger_lock; // mutex for ledger
 
 list<struct Ledger> ledger; // list of ledger entries
-Bank *bank;					// bank object
+template <class BankT>
+BankT *bank;				// bank object
 fstream myfile[10];			// log files
+bool admission_control = false; // defer and coalesce entries for hot accounts
+int *inflight;				// entries in flight per account
+int front_skips;			// times the oldest entry has been deferred
 
 /**
  * @brief creates a new bank object and sets up workers
@@ -21,16 +25,36 @@ fstream myfile[10];			// log files
  */
 void InitBank(int num_workers, char *filename)
 {
-	bank = new Bank(10);					 // create a new bank object with 10 accounts
-	bank->print_account();					 // print the initial account balances
-	load_ledger(filename);					 // load the ledger into a list
-	pthread_t threads[num_workers];			 // create an array of threads
-	int workerID[num_workers];				 // create an array of worker IDs
-	ledger_lock = PTHREAD_MUTEX_INITIALIZER; // initialize the ledger lock
-	for (int i = 0; i < 10; ++i)
-	{
-		string filename = "log_account_" + to_string(i) + ".txt"; // create a log file for each account
-		myfile[i].open(filename);								  // open the log file
+	RunLedger<Bank>(num_workers, filename); // run with every feature on
+}
+
+/**
+ * @brief runs a ledger on a bank of the given configuration
+ *
+ * A configuration without locking is driven by a single worker.
+ *
+ * @param num_workers
+ * @param filename
+ */
+template <class BankT>
+void RunLedger(int num_workers, char *filename)
+{
+	if (!BankT::lock_policy::thread_safe)
+	{
+		num_workers = 1; // no locks, so no concurrency
+	}
+	bank<BankT> = new BankT(10);			  // create a new bank object with 10 accounts
+	bank<BankT>->print_account();			  // print the initial account balances
+	load_ledger(filename);					  // load the ledger into a list
+	pthread_t threads[num_workers];			  // create an array of threads
+	int workerID[num_workers];				  // create an array of worker IDs
+	ledger_lock = PTHREAD_MUTEX_INITIALIZER;  // initialize the ledger lock
+	inflight = new int[bank<BankT>->size()](); // no entries in flight
+	front_skips = 0;						  // nothing deferred yet
+	for (int i = 0; i < 10 && BankT::log_policy::enabled; ++i)
+	{
+		string filename = "log_account_" + to_string(i) + ".bin";				   // create a log file for each account
+		myfile[i].open(filename, ios::in | ios::out | ios::binary | ios::trunc); // open the binary log file
 		if (!myfile[i].is_open())								  // check if the file is open
 		{
 			cerr << "Error opening log file for account " << i << endl; // error if the file cannot be opened
@@ -41,7 +65,7 @@ void InitBank(int num_workers, char *filename)
 	for (int i = 0; i < num_workers; ++i)
 	{
 		workerID[i] = i;												  // set the worker ID
-		if (pthread_create(&threads[i], NULL, worker, &workerID[i]) != 0) // create a thread for each worker
+		if (pthread_create(&threads[i], NULL, worker<BankT>, &workerID[i]) != 0) // create a thread for each worker
 		{
 			exit(1); // exit the program if the thread cannot be created
 		}
@@ -55,13 +79,17 @@ void InitBank(int num_workers, char *filename)
 		}
 		else if (i == num_workers - 1)
 		{
-			bank->print_account();				 // print the final account balances
+			bank<BankT>->print_account();		 // print the final account balances
+			struct AuditReport report;			 // audit the final balances
+			audit_bank(bank<BankT>, &report);	 // check the conservation of money
+			print_audit(&report);				 // print the audit result
 			pthread_mutex_destroy(&ledger_lock); // destroy the ledger lock
-			delete bank;						 // delete the bank object
+			delete[] inflight;					 // free the in-flight counts
+			delete bank<BankT>;					 // delete the bank object
 		}
 	}
 
-	for (int i = 0; i < 10; ++i)
+	for (int i = 0; i < 10 && BankT::log_policy::enabled; ++i)
 	{
 		myfile[i].close(); // close the log files
 	}
@@ -89,41 +117,237 @@ void load_ledger(char *filename)
 	}
 }
 
+// whether enough workers wait on an account's lock to be worth avoiding
+static bool hot(int accountID)
+{
+	return inflight[accountID] - 1 >= HOT_ACCOUNT_WAITERS; // one entry runs, the rest wait
+}
+
+// whether an entry touches a hot account
+static bool touches_hot(struct Ledger *entry)
+{
+	return hot(entry->acc) || (entry->mode == T && hot(entry->other));
+}
+
+// whether an entry uses an account
+static bool touches(struct Ledger *entry, int accountID)
+{
+	return entry->acc == accountID || (entry->mode == T && entry->other == accountID);
+}
+
+// whether an entry uses an account of an earlier entry that was passed over
+static bool touches_skipped(struct Ledger *entry, int *skipped, int num_skipped)
+{
+	for (int i = 0; i < num_skipped; i++)
+	{
+		if (touches(entry, skipped[i]))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Takes the next batch of ledger entries for a worker and marks
+ *        their accounts as in flight. The caller holds the ledger lock and
+ *        the ledger is not empty.
+ *
+ * Without admission control this is the oldest entry. With it, the first
+ * ADMISSION_WINDOW entries are searched for one that touches no hot
+ * account, so workers keep running independent work instead of queueing on
+ * a busy account lock. An entry sharing an account with an earlier entry
+ * that was passed over is not taken either, so each account still sees its
+ * entries in ledger order. The oldest entry is taken anyway once no entry
+ * in the window qualifies, or once it has been passed over ADMISSION_WINDOW
+ * times. A deposit to a hot account takes the following queued deposits to
+ * that account with it, to be applied as one locked update, up to the
+ * first other entry on that account.
+ *
+ * @param batch receives the entries to execute (all deposits if several)
+ */
+void admit(vector<struct Ledger> *batch)
+{
+	list<struct Ledger>::iterator pick = ledger.begin(); // default to the oldest entry
+	if (admission_control && front_skips < ADMISSION_WINDOW)
+	{
+		int skipped[2 * ADMISSION_WINDOW]; // accounts of the entries passed over
+		int num_skipped = 0;
+		list<struct Ledger>::iterator it = ledger.begin();
+		for (int i = 0; i < ADMISSION_WINDOW && it != ledger.end(); i++, it++)
+		{
+			if (!touches_hot(&*it) && !touches_skipped(&*it, skipped, num_skipped)) // independent work
+			{
+				pick = it;
+				break;
+			}
+			skipped[num_skipped++] = it->acc;
+			if (it->mode == T)
+			{
+				skipped[num_skipped++] = it->other;
+			}
+		}
+	}
+	front_skips = pick == ledger.begin() ? 0 : front_skips + 1; // age the oldest entry
+
+	struct Ledger entry = *pick;
+	batch->push_back(entry);
+	pick = ledger.erase(pick);
+	if (admission_control && entry.mode == D && entry.amount >= 0 && hot(entry.acc))
+	{
+		list<struct Ledger>::iterator it = pick;
+		for (int i = 0; i < ADMISSION_WINDOW && it != ledger.end(); i++)
+		{
+			if (!touches(&*it, entry.acc)) // other accounts
+			{
+				it++;
+			}
+			else if (it->mode == D && it->amount >= 0) // coalesce
+			{
+				batch->push_back(*it);
+				it = ledger.erase(it);
+			}
+			else
+			{
+				break; // keep later deposits behind it
+			}
+		}
+	}
+
+	for (size_t i = 0; i < batch->size(); i++)
+	{
+		inflight[(*batch)[i].acc]++; // mark accounts in flight
+		if ((*batch)[i].mode == T)
+		{
+			inflight[(*batch)[i].other]++;
+		}
+	}
+}
+
+/**
+ * @brief Releases the accounts of a finished batch. The caller holds the
+ *        ledger lock.
+ *
+ * @param batch the entries that were executed
+ */
+void release(vector<struct Ledger> *batch)
+{
+	for (size_t i = 0; i < batch->size(); i++)
+	{
+		inflight[(*batch)[i].acc]--;
+		if ((*batch)[i].mode == T)
+		{
+			inflight[(*batch)[i].other]--;
+		}
+	}
+	batch->clear();
+}
+
+// Handler executing one kind of ledger entry, specialized per mode
+template <class BankT, int Mode>
+struct LedgerOp;
+
+template <class BankT>
+struct LedgerOp<BankT, D>
+{
+	static void run(BankT *b, int workerID, struct Ledger *entry)
+	{
+		b->deposit(workerID, entry->ledgerID, entry->acc, entry->amount, &myfile[entry->acc]); // deposit
+	}
+};
+
+template <class BankT>
+struct LedgerOp<BankT, W>
+{
+	static void run(BankT *b, int workerID, struct Ledger *entry)
+	{
+		b->withdraw(workerID, entry->ledgerID, entry->acc, entry->amount, &myfile[entry->acc]); // withdraw
+	}
+};
+
+template <class BankT>
+struct LedgerOp<BankT, T>
+{
+	static void run(BankT *b, int workerID, struct Ledger *entry)
+	{
+		b->transfer(workerID, entry->ledgerID, entry->acc, entry->other, entry->amount, &myfile[entry->acc], &myfile[entry->other]); // transfer
+	}
+};
+
+template <class BankT>
+struct LedgerOp<BankT, C>
+{
+	static void run(BankT *b, int workerID, struct Ledger *entry)
+	{
+		b->check_balance(workerID, entry->ledgerID, entry->acc, &myfile[entry->acc]); // check balance
+	}
+};
+
+template <class BankT>
+struct LedgerOp<BankT, P>
+{
+	static void run(BankT *b, int workerID, struct Ledger *entry)
+	{
+		b->printAccountLog(workerID, entry->ledgerID, entry->acc, &myfile[entry->acc]); // print account log
+	}
+};
+
 /**
  * @brief Remove items from the list and execute the instruction.
  *
  * @param workerID
  * @return void*
  */
+template <class BankT>
 void *worker(void *workerID)
 {
+	vector<struct Ledger> batch;	  // entries taken from the ledger
 	pthread_mutex_lock(&ledger_lock); // lock the ledger
 	while (!ledger.empty())			  // while the ledger is not empty
 	{
-		Ledger entry = ledger.front();		// get the first entry in the ledger
-		ledger.pop_front();					// remove the first entry from the ledger
+		admit(&batch);						// take the next entries from the ledger
 		pthread_mutex_unlock(&ledger_lock); // unlock the ledger
-		if (entry.mode == 0)				// execute the instruction
-		{
-			(*bank).deposit(*(int *)workerID, entry.ledgerID, entry.acc, entry.amount, &myfile[entry.acc]); // deposit
-		}
-		else if (entry.mode == 1) // execute the instruction
+		Ledger entry = batch[0];			// the first entry taken
+		if (batch.size() > 1)				// coalesced deposits
 		{
-			(*bank).withdraw(*(int *)workerID, entry.ledgerID, entry.acc, entry.amount, &myfile[entry.acc]); // withdraw
+			vector<int> ledgerIDs, amounts;
+			for (size_t i = 0; i < batch.size(); i++)
+			{
+				ledgerIDs.push_back(batch[i].ledgerID);
+				amounts.push_back(batch[i].amount);
+			}
+			bank<BankT>->deposit_many(*(int *)workerID, batch.size(), ledgerIDs.data(), entry.acc, amounts.data(), &myfile[entry.acc]); // deposits
 		}
-		else if (entry.mode == 2) // execute the instruction
+		else
 		{
-			(*bank).transfer(*(int *)workerID, entry.ledgerID, entry.acc, entry.other, entry.amount, &myfile[entry.acc], &myfile[entry.other]); // transfer
-		}
-		else if (entry.mode == 3) // execute the instruction
-		{
-			(*bank).check_balance(*(int *)workerID, entry.ledgerID, entry.acc, &myfile[entry.acc]); // check balance
-		}
-		else if (entry.mode == 4) // execute the instruction
-		{
-			(*bank).printAccountLog(*(int *)workerID, entry.ledgerID, entry.acc, &myfile[entry.acc]); // print account log
+			switch (entry.mode) // execute the instruction, calling each handler directly so it inlines
+			{
+			case D:
+				LedgerOp<BankT, D>::run(bank<BankT>, *(int *)workerID, &entry);
+				break;
+			case W:
+				LedgerOp<BankT, W>::run(bank<BankT>, *(int *)workerID, &entry);
+				break;
+			case T:
+				LedgerOp<BankT, T>::run(bank<BankT>, *(int *)workerID, &entry);
+				break;
+			case C:
+				LedgerOp<BankT, C>::run(bank<BankT>, *(int *)workerID, &entry);
+				break;
+			case P:
+				LedgerOp<BankT, P>::run(bank<BankT>, *(int *)workerID, &entry);
+				break;
+			}
 		}
 		pthread_mutex_lock(&ledger_lock); // lock the ledger
+		release(&batch);				  // the accounts are no longer in flight
 	}
 	pthread_mutex_unlock(&ledger_lock); // unlock the ledger
+	return NULL;
 }
+
+// Bank configurations a ledger can run on
+template void RunLedger<Bank>(int num_workers, char *filename);
+template void RunLedger<QuietBank>(int num_workers, char *filename);
+template void RunLedger<LeanBank>(int num_workers, char *filename);
+template void RunLedger<SerialBank>(int num_workers, char *filename);
@@ -0,0 +1,35 @@
+#include <log_record.h>
+#include <iostream>
+
+using namespace std;
+
+// Prints binary account logs in the text log format
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    cerr << "Usage: " << argv[0] << " <log_file>...\n" << endl;
+    exit(-1);
+  }
+
+  for (int i = 1; i < argc; i++)
+  {
+    ifstream file(argv[i], ios::binary);
+    if (!file.is_open())
+    {
+      cerr << "Error opening log file " << argv[i] << endl;
+      exit(1);
+    }
+    if (argc > 2)
+    {
+      cout << "==> " << argv[i] << " <==" << endl;
+    }
+    LogRecord rec;
+    while (read_log_record(&file, &rec))
+    {
+      cout << render_log_record(&rec) << '\n';
+    }
+  }
+
+  return 0;
+}
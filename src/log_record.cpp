@@ -0,0 +1,79 @@
+#include <log_record.h>
+#include <time.h>
+
+using namespace std;
+
+/**
+ * @brief Fills in a log record stamped with the current time
+ *
+ * @param rec the record to fill in
+ * @param op the operation (LOG_DEPOSIT, LOG_WITHDRAW, ...)
+ * @param status LOG_SUCCESS or LOG_FAILED
+ * @param amount the requested amount
+ * @param counterparty the other account of a transfer, -1 otherwise
+ * @param ledgerID the ID of the ledger entry
+ */
+void make_log_record(struct LogRecord *rec, int op, int status, int amount, int counterparty, int ledgerID)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts); // wall clock, so logs can be correlated
+	rec->timestamp = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	rec->amount = amount;
+	rec->counterparty = counterparty;
+	rec->ledgerID = ledgerID;
+	rec->op = op;
+	rec->status = status;
+	rec->reserved = 0;
+}
+
+/**
+ * @brief Renders a log record in the text log format
+ *
+ * Failed operations are shown with an amount of 0, as the text logs did.
+ *
+ * @param rec the record to render
+ * @return string the log line, without a trailing newline
+ */
+string render_log_record(const struct LogRecord *rec)
+{
+	string amount = to_string(rec->status == LOG_SUCCESS ? rec->amount : 0);
+	string status = rec->status == LOG_SUCCESS ? "Success" : "Failed";
+	switch (rec->op)
+	{
+	case LOG_DEPOSIT:
+		return "Transaction Type: Deposit, Amount: " + amount + ", Status: " + status;
+	case LOG_WITHDRAW:
+		return "Transaction Type: Withdraw, Amount: " + amount + ", Status: " + status;
+	case LOG_TRANSFER_OUT:
+		return "Transaction Type: Transfer, Amount: " + amount + ", Receiver: " + to_string(rec->counterparty) + ", Status: " + status;
+	case LOG_TRANSFER_IN:
+		return "Transaction Type: Transfer, Amount: " + amount + ", Sender: " + to_string(rec->counterparty) + ", Status: " + status;
+	case LOG_CHECK_BALANCE:
+		return "Transaction Type: Check Balance, Amount: 0, Status: " + status;
+	}
+	return "Transaction Type: Unknown (" + to_string(rec->op) + ")";
+}
+
+/**
+ * @brief Appends a log record to a log file
+ *
+ * @param file the log file, opened in binary mode
+ * @param rec the record to write
+ */
+void write_log_record(fstream *file, const struct LogRecord *rec)
+{
+	file->write((const char *)rec, sizeof(struct LogRecord));
+}
+
+/**
+ * @brief Reads the next log record from a log stream
+ *
+ * @param file the log stream, opened in binary mode
+ * @param rec where to store the record
+ * @return true if a whole record was read
+ */
+bool read_log_record(istream *file, struct LogRecord *rec)
+{
+	file->read((char *)rec, sizeof(struct LogRecord));
+	return file->gcount() == sizeof(struct LogRecord);
+}
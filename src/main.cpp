@@ -1,13 +1,19 @@
 #include <ledger.h>
 
+// Bank configuration to run, selected by the Makefile preset targets
+#ifndef BANK_PRESET
+#define BANK_PRESET Bank
+#endif
+
 int main(int argc, char* argv[]) {
-  if (argc != 3) {
-    cerr << "Usage: " << argv[0] << " <num_of_threads> <leader_file>\n" << endl;
+  if (argc != 3 && !(argc == 4 && string(argv[3]) == "--admission")) {
+    cerr << "Usage: " << argv[0] << " <num_of_threads> <leader_file> [--admission]\n" << endl;
     exit(-1);
   }
+  admission_control = argc == 4; // defer and coalesce entries for hot accounts
 
   int p = atoi(argv[1]);
-  InitBank(p, argv[2]);
+  RunLedger<BANK_PRESET>(p, argv[2]);
 
   return 0;
 }
@@ -78,6 +78,386 @@ TEST(BankTest, Test5)
   delete bank_t;
 }
 
+// check audit totals and the conservation of money
+TEST(BankTest, Audit)
+{
+  bank_t = new Bank(10);
+  fstream log("/dev/null", ios::out);
+
+  stringstream output;
+  streambuf *oldCoutStreamBuf = cout.rdbuf(); // silence operation messages
+  cout.rdbuf(output.rdbuf());
+  bank_t->deposit(0, 0, 1, 100, &log);
+  bank_t->deposit(0, 1, 2, 50, &log);
+  bank_t->withdraw(0, 2, 1, 30, &log);
+  bank_t->transfer(0, 3, 2, 3, 20, &log, &log);
+  bank_t->withdraw(0, 4, 4, 10, &log); // fails, empty account
+  cout.rdbuf(oldCoutStreamBuf);
+
+  struct AuditReport report;
+  EXPECT_EQ(audit_bank(bank_t, &report), 0) << "Books should balance";
+  EXPECT_EQ(report.total, 120);
+  EXPECT_EQ(report.deposited, 150);
+  EXPECT_EQ(report.withdrawn, 30);
+  EXPECT_EQ(report.min_balance, 0);
+  EXPECT_EQ(report.max_balance, 70);
+  EXPECT_EQ(report.negatives, 0);
+  EXPECT_EQ(report.version, 4u) << "Four successful updates, four commits";
+
+  long column[] = {5, -3, 7, 0, -9, 2, 11};
+  long lo, hi;
+  audit_min_max(column, 7, &lo, &hi);
+  EXPECT_EQ(audit_sum(column, 7), 13);
+  EXPECT_EQ(lo, -9);
+  EXPECT_EQ(hi, 11);
+  EXPECT_EQ(audit_count_negative(column, 7), 2);
+  delete bank_t;
+}
+
+// check snapshots keep a point-in-time view while writers continue
+TEST(BankTest, Snapshot)
+{
+  bank_t = new Bank(10);
+  fstream log("/dev/null", ios::out);
+
+  stringstream output;
+  streambuf *oldCoutStreamBuf = cout.rdbuf(); // silence operation messages
+  cout.rdbuf(output.rdbuf());
+  bank_t->deposit(0, 0, 1, 100, &log);
+
+  Snapshot before;
+  bank_t->open_snapshot(&before);
+  bank_t->transfer(0, 1, 1, 2, 40, &log, &log);
+  bank_t->deposit(0, 2, 1, 5, &log);
+  bank_t->deposit(0, 3, 1, 5, &log); // older versions of account 1 are reclaimable
+
+  Snapshot after;
+  bank_t->open_snapshot(&after);
+  cout.rdbuf(oldCoutStreamBuf);
+
+  EXPECT_EQ(bank_t->read_balance(1, &before), 100) << "Snapshot must not see later commits";
+  EXPECT_EQ(bank_t->read_balance(2, &before), 0) << "Snapshot must not see later commits";
+  EXPECT_EQ(bank_t->read_balance(1, &after), 70);
+  EXPECT_EQ(bank_t->read_balance(2, &after), 40);
+  EXPECT_EQ(bank_t->read_balance(3, &after), 0) << "Untouched accounts read as zero";
+  bank_t->close_snapshot(&before);
+  bank_t->close_snapshot(&after);
+
+  cout.rdbuf(output.rdbuf());
+  bank_t->deposit(0, 4, 1, 5, &log); // no snapshot open, so the chain is trimmed
+  cout.rdbuf(oldCoutStreamBuf);
+  ASSERT_NE(bank_t->accounts[1].head, (BalanceVersion *)NULL);
+  EXPECT_EQ(bank_t->accounts[1].head->prev, (BalanceVersion *)NULL) << "Versions nobody can read should be reclaimed";
+  EXPECT_NE(bank_t->accounts[1].spare, (BalanceVersion *)NULL) << "Reclaimed versions should be kept for reuse";
+  delete bank_t;
+}
+
+const int SNAPSHOT_WRITERS = 4;
+const int SNAPSHOT_TRANSFERS = 20000;
+
+QuietBank *snapshot_bank;
+fstream snapshot_logs[10]; // one per account, written under its lock
+
+// moves money between random accounts
+static void *snapshot_writer(void *arg)
+{
+  unsigned int seed = *(int *)arg;
+  for (int i = 0; i < SNAPSHOT_TRANSFERS; i++)
+  {
+    int src = rand_r(&seed) % 10;
+    int dest = (src + 1 + rand_r(&seed) % 9) % 10;
+    snapshot_bank->transfer(0, i, src, dest, rand_r(&seed) % 50, &snapshot_logs[src], &snapshot_logs[dest]);
+  }
+  return NULL;
+}
+
+// check snapshots stay conserved while several writers transfer
+TEST(BankTest, ConcurrentSnapshot)
+{
+  snapshot_bank = new QuietBank(10);
+  for (int i = 0; i < 10; i++)
+  {
+    snapshot_logs[i].open("/dev/null", ios::out);
+    snapshot_bank->deposit(0, i, i, 1000, &snapshot_logs[i]);
+  }
+
+  pthread_t threads[SNAPSHOT_WRITERS];
+  int seeds[SNAPSHOT_WRITERS];
+  for (int i = 0; i < SNAPSHOT_WRITERS; i++)
+  {
+    seeds[i] = i + 1;
+    ASSERT_EQ(pthread_create(&threads[i], NULL, snapshot_writer, &seeds[i]), 0);
+  }
+  int reports = 0;
+  void *status;
+  while (pthread_tryjoin_np(threads[0], &status) != 0 || reports == 0) // report until the writers finish
+  {
+    Snapshot snap;
+    snapshot_bank->open_snapshot(&snap);
+    long total = 0;
+    for (int i = 0; i < 10; i++)
+    {
+      total += snapshot_bank->read_balance(i, &snap);
+    }
+    snapshot_bank->close_snapshot(&snap);
+    EXPECT_EQ(total, 10000) << "Snapshot must see whole transfers only";
+    reports++;
+  }
+  for (int i = 1; i < SNAPSHOT_WRITERS; i++)
+  {
+    pthread_join(threads[i], NULL);
+  }
+
+  struct AuditReport report;
+  EXPECT_EQ(audit_bank(snapshot_bank, &report), 0);
+  EXPECT_EQ(report.total, 10000);
+  for (int i = 0; i < 10; i++)
+  {
+    snapshot_bank->deposit(0, i, i, 0, &snapshot_logs[i]); // no snapshot open, so the chain is trimmed
+    EXPECT_EQ(snapshot_bank->accounts[i].head->prev, (BalanceVersion *)NULL) << "Account " << i << " kept old versions";
+    snapshot_logs[i].close();
+  }
+  delete snapshot_bank;
+}
+
+// check binary log records and their text rendering
+TEST(BankTest, LogRecords)
+{
+  ASSERT_EQ(sizeof(LogRecord), 24u) << "Log records must stay fixed-width";
+
+  bank_t = new Bank(10);
+  string path = "test_log_account.bin";
+  fstream log(path, ios::in | ios::out | ios::binary | ios::trunc);
+
+  stringstream output;
+  streambuf *oldCoutStreamBuf = cout.rdbuf(); // capture printed log
+  cout.rdbuf(output.rdbuf());
+  bank_t->deposit(0, 0, 1, 100, &log);
+  bank_t->withdraw(0, 1, 1, 500, &log);
+  bank_t->transfer(0, 2, 1, 2, 40, &log, &log);
+  bank_t->check_balance(0, 3, 1, &log);
+  output.str("");
+  bank_t->printAccountLog(0, 4, 1, &log);
+  bank_t->deposit(0, 5, 1, 7, &log); // appends still go to the end
+  cout.rdbuf(oldCoutStreamBuf);
+
+  string expected = "Transaction Type: Deposit, Amount: 100, Status: Success\n"
+                    "Transaction Type: Withdraw, Amount: 0, Status: Failed\n"
+                    "Transaction Type: Transfer, Amount: 40, Receiver: 2, Status: Success\n"
+                    "Transaction Type: Transfer, Amount: 40, Sender: 1, Status: Success\n"
+                    "Transaction Type: Check Balance, Amount: 0, Status: Success\n";
+  EXPECT_EQ(output.str().substr(0, expected.length()), expected);
+
+  log.close();
+  ifstream in(path, ios::binary);
+  LogRecord rec;
+  int count = 0;
+  while (read_log_record(&in, &rec))
+  {
+    count++;
+  }
+  EXPECT_EQ(count, 6);
+  EXPECT_EQ(rec.op, LOG_DEPOSIT);
+  EXPECT_EQ(rec.amount, 7);
+  EXPECT_EQ(rec.ledgerID, 5);
+  remove(path.c_str());
+  delete bank_t;
+}
+
+// check coalesced deposits apply as one update with one log record each
+TEST(BankTest, DepositMany)
+{
+  bank_t = new Bank(10);
+  string path = "test_log_account.bin";
+  fstream log(path, ios::in | ios::out | ios::binary | ios::trunc);
+
+  stringstream output;
+  streambuf *oldCoutStreamBuf = cout.rdbuf(); // silence operation messages
+  cout.rdbuf(output.rdbuf());
+  int ledgerIDs[] = {3, 7, 9};
+  int amounts[] = {10, 20, 30};
+  bank_t->deposit_many(0, 3, ledgerIDs, 4, amounts, &log);
+  bank_t->print_account();
+  cout.rdbuf(oldCoutStreamBuf);
+
+  EXPECT_NE(output.str().find("completed ledger 7: deposit 20 into account 4"), string::npos);
+  EXPECT_NE(output.str().find("Success: 3 Fails: 0"), string::npos);
+
+  struct AuditReport report;
+  EXPECT_EQ(audit_bank(bank_t, &report), 0);
+  EXPECT_EQ(report.max_balance, 60);
+  EXPECT_EQ(report.version, 1u) << "Coalesced deposits should publish once";
+
+  log.close();
+  ifstream in(path, ios::binary);
+  LogRecord rec;
+  int count = 0;
+  while (read_log_record(&in, &rec))
+  {
+    EXPECT_EQ(rec.ledgerID, ledgerIDs[count]);
+    count++;
+  }
+  EXPECT_EQ(count, 3);
+  remove(path.c_str());
+  delete bank_t;
+}
+
+// queue a ledger entry
+static void push_entry(int acc, int other, int amount, int mode, int ledgerID)
+{
+  struct Ledger l = {acc, other, amount, mode, ledgerID};
+  ledger.push_back(l);
+}
+
+// check admission control skips hot accounts, but not forever
+TEST(BankTest, AdmitSkipsHot)
+{
+  ledger.clear();
+  inflight = new int[10]();
+  front_skips = 0;
+  admission_control = true;
+  vector<struct Ledger> batch;
+  const int HOT = HOT_ACCOUNT_WAITERS + 1; // one running, the rest waiting
+
+  inflight[1] = HOT;
+  inflight[4] = 1;            // running, nobody waiting
+  push_entry(1, 0, 10, D, 0); // hot account
+  push_entry(2, 1, 10, T, 1); // hot destination
+  push_entry(2, 6, 10, T, 2); // shares account 2 with a skipped entry
+  push_entry(6, 3, 10, T, 3); // shares account 6 with a skipped entry
+  push_entry(4, 0, 10, D, 4); // independent
+  admit(&batch);
+  ASSERT_EQ(batch.size(), 1u);
+  EXPECT_EQ(batch[0].ledgerID, 4) << "First independent entry should be taken";
+  EXPECT_EQ(front_skips, 1);
+  EXPECT_EQ(inflight[4], 2);
+  release(&batch);
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(inflight[4], 1);
+
+  admit(&batch);
+  ASSERT_EQ(batch.size(), 1u);
+  EXPECT_EQ(batch[0].ledgerID, 0) << "Oldest entry should be taken when none is independent";
+  EXPECT_EQ(front_skips, 0);
+  EXPECT_EQ(inflight[1], HOT + 1);
+  release(&batch);
+  EXPECT_EQ(inflight[1], HOT);
+
+  push_entry(8, 0, 10, D, 5);
+  front_skips = ADMISSION_WINDOW; // oldest entry passed over too often
+  admit(&batch);
+  ASSERT_EQ(batch.size(), 1u);
+  EXPECT_EQ(batch[0].ledgerID, 1) << "Starved oldest entry should be taken";
+  EXPECT_EQ(front_skips, 0);
+  EXPECT_EQ(inflight[1], HOT + 1);
+  EXPECT_EQ(inflight[2], 1);
+  release(&batch);
+  EXPECT_EQ(inflight[1], HOT);
+  EXPECT_EQ(inflight[2], 0);
+
+  ledger.clear();
+  for (int i = 0; i < ADMISSION_WINDOW; i++)
+  {
+    push_entry(1, 0, 10, W, i); // window full of hot entries
+  }
+  push_entry(2, 0, 10, D, ADMISSION_WINDOW);
+  admit(&batch);
+  ASSERT_EQ(batch.size(), 1u);
+  EXPECT_EQ(batch[0].ledgerID, 0) << "Entries past the window should not be searched";
+  EXPECT_EQ(front_skips, 0);
+  release(&batch);
+
+  admission_control = false;
+  ledger.clear();
+  push_entry(1, 0, 10, D, 0);
+  push_entry(2, 0, 10, D, 1);
+  admit(&batch);
+  EXPECT_EQ(batch[0].ledgerID, 0) << "Without admission control the oldest entry is taken";
+  release(&batch);
+
+  ledger.clear();
+  delete[] inflight;
+}
+
+// check deposits to a hot account are coalesced without reordering it
+TEST(BankTest, AdmitCoalesces)
+{
+  ledger.clear();
+  inflight = new int[10]();
+  front_skips = ADMISSION_WINDOW; // take the oldest entry
+  admission_control = true;
+  vector<struct Ledger> batch;
+  const int HOT = HOT_ACCOUNT_WAITERS + 1;
+
+  inflight[3] = HOT;
+  push_entry(3, 0, 10, D, 0);
+  push_entry(4, 0, 5, D, 1); // other account
+  push_entry(3, 0, 20, D, 2);
+  push_entry(3, 0, 15, W, 3); // must see only the deposits before it
+  push_entry(3, 0, 30, D, 4);
+  admit(&batch);
+  ASSERT_EQ(batch.size(), 2u);
+  EXPECT_EQ(batch[0].ledgerID, 0);
+  EXPECT_EQ(batch[1].ledgerID, 2);
+  EXPECT_EQ(inflight[3], HOT + 2);
+
+  ASSERT_EQ(ledger.size(), 3u);
+  int left[] = {1, 3, 4};
+  int i = 0;
+  for (list<struct Ledger>::iterator it = ledger.begin(); it != ledger.end(); it++)
+  {
+    EXPECT_EQ(it->ledgerID, left[i++]) << "Deposits after the withdrawal should stay behind it";
+  }
+  release(&batch);
+  EXPECT_EQ(inflight[3], HOT);
+  EXPECT_EQ(inflight[4], 0);
+
+  ledger.clear();
+  front_skips = ADMISSION_WINDOW;
+  push_entry(3, 0, 10, D, 0);
+  push_entry(5, 3, 10, T, 1); // transfer into the account
+  push_entry(3, 0, 20, D, 2);
+  admit(&batch);
+  EXPECT_EQ(batch.size(), 1u) << "A transfer into the account should stop coalescing";
+  release(&batch);
+
+  admission_control = false;
+  ledger.clear();
+  delete[] inflight;
+}
+
+// check compiled-out features in the preset configurations
+TEST(BankTest, Presets)
+{
+  QuietBank *quiet = new QuietBank(10);
+  SerialBank *serial = new SerialBank(10);
+  fstream log("/dev/null", ios::out);
+
+  stringstream output;
+  streambuf *oldCoutStreamBuf = cout.rdbuf(); // capture console output
+  cout.rdbuf(output.rdbuf());
+  quiet->deposit(0, 0, 1, 100, &log);
+  quiet->withdraw(0, 1, 1, 500, &log);
+  serial->deposit(0, 0, 1, 100, &log);
+  serial->transfer(0, 1, 1, 2, 40, &log, &log);
+  EXPECT_EQ(output.str(), "") << "Presets without console output must not print";
+  quiet->print_account();
+  serial->print_account();
+  cout.rdbuf(oldCoutStreamBuf);
+
+  EXPECT_NE(output.str().find("Success: 1 Fails: 1"), string::npos) << "QuietBank still counts";
+  EXPECT_NE(output.str().find("Success: 0 Fails: 0"), string::npos) << "SerialBank has no counters";
+
+  struct AuditReport report;
+  EXPECT_EQ(audit_bank(serial, &report), 0);
+  EXPECT_EQ(report.max_balance, 60);
+  EXPECT_EQ(report.version, 0u) << "SerialBank publishes no versions";
+  EXPECT_EQ(serial->accounts[1].head, (BalanceVersion *)NULL) << "SerialBank publishes no versions";
+  EXPECT_NE(quiet->accounts[1].head, (BalanceVersion *)NULL) << "QuietBank keeps versions";
+  delete quiet;
+  delete serial;
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);